@@ -119,6 +119,13 @@ typedef enum
     FNL_DOMAIN_WARP_BASICGRID
 } fnl_domain_warp_type;
 
+typedef enum
+{
+    FNL_SIMD_NONE,
+    FNL_SIMD_SSE41,
+    FNL_SIMD_AVX2
+} fnl_simd_level;
+
 /**
  * Structure containing entire noise system state.
  * @note Must only be created using fnlCreateState(optional: seed). To ensure defaults are set.
@@ -237,6 +244,33 @@ float fnlGetNoise2D(fnl_state *state, FNLfloat x, FNLfloat y);
  */
 float fnlGetNoise3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z);
 
+/**
+ * 2D noise for a row of samples using the state settings.
+ * Fills out[0..count) with the noise at (x + i * xstep, y).
+ * @note Gives the same output as calling fnlGetNoise2D per sample, but decodes
+ * the state and selects the noise/fractal path once per row instead of once per sample.
+ */
+void fnlGetNoiseRow2D(fnl_state *state, float *out, int count, FNLfloat x, FNLfloat y, FNLfloat xstep);
+
+/**
+ * 3D noise for a row of samples using the state settings.
+ * Fills out[0..count) with the noise at (x + i * xstep, y, z).
+ * @note See fnlGetNoiseRow2D.
+ */
+void fnlGetNoiseRow3D(fnl_state *state, float *out, int count, FNLfloat x, FNLfloat y, FNLfloat z, FNLfloat xstep);
+
+/**
+ * Instruction set used by the row functions.
+ * @remark Detected from the CPU on first use, FNL_SIMD_NONE when built without FNL_SIMD_X86.
+ */
+fnl_simd_level fnlGetSIMDLevel();
+
+/**
+ * Caps the instruction set used by the row functions, e.g. to compare against the scalar path.
+ * @returns The level actually selected, never higher than what the CPU supports.
+ */
+fnl_simd_level fnlSetSIMDLevel(fnl_simd_level level);
+
 /**
  * 2D warps the input position using current domain warp settings.
  * 
@@ -899,6 +933,421 @@ static float _fnlGenFractalPingPong3D(fnl_state *state, FNLfloat x, FNLfloat y,
     return sum;
 }
 
+// Samples per block in the row functions and span kernels
+#define FNL_SPAN_BLOCK 64
+
+// SIMD
+//
+// Span kernels are picked from a table once per process. The x86 tables are generated from
+// fastnoise_simd.h for SSE4.1 and AVX2, the scalar table is the fallback everywhere else.
+// Define FNL_NO_SIMD to build the scalar path only.
+
+#if !defined(FNL_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FNL_SIMD_X86
+#include <immintrin.h>
+// The kernels load FNLfloat coordinates straight into float lanes.
+typedef char _fnlSimdNeedsFloatCoords[sizeof(FNLfloat) == sizeof(float) ? 1 : -1];
+#endif
+
+typedef struct _fnlSpanKernels
+{
+    void (*simplex2D)(int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count);
+    void (*openSimplex23D)(int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count);
+    void (*perlin2D)(int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count);
+    void (*perlin3D)(int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count);
+    void (*cellular2D)(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count);
+    void (*cellular3D)(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count);
+} _fnlSpanKernels;
+
+static void _fnlSimplexSpan2D_scalar(int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    for (int i = 0; i < count; i++) out[i] = _fnlSingleSimplex2D(seed, x[i], y[i]);
+}
+
+static void _fnlOpenSimplex2Span3D_scalar(int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    for (int i = 0; i < count; i++) out[i] = _fnlSingleOpenSimplex23D(seed, x[i], y[i], z[i]);
+}
+
+static void _fnlPerlinSpan2D_scalar(int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    for (int i = 0; i < count; i++) out[i] = _fnlSinglePerlin2D(seed, x[i], y[i]);
+}
+
+static void _fnlPerlinSpan3D_scalar(int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    for (int i = 0; i < count; i++) out[i] = _fnlSinglePerlin3D(seed, x[i], y[i], z[i]);
+}
+
+static void _fnlCellularSpan2D_scalar(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    for (int i = 0; i < count; i++) out[i] = _fnlSingleCellular2D(state, seed, x[i], y[i]);
+}
+
+static void _fnlCellularSpan3D_scalar(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    for (int i = 0; i < count; i++) out[i] = _fnlSingleCellular3D(state, seed, x[i], y[i], z[i]);
+}
+
+static const _fnlSpanKernels _fnlSpanKernels_scalar = {
+    _fnlSimplexSpan2D_scalar,
+    _fnlOpenSimplex2Span3D_scalar,
+    _fnlPerlinSpan2D_scalar,
+    _fnlPerlinSpan3D_scalar,
+    _fnlCellularSpan2D_scalar,
+    _fnlCellularSpan3D_scalar,
+};
+
+#if defined(FNL_SIMD_X86)
+#define FNLV_WIDTH 4
+#include "fastnoise_simd.h"
+#undef FNLV_WIDTH
+
+#define FNLV_WIDTH 8
+#include "fastnoise_simd.h"
+#undef FNLV_WIDTH
+#endif
+
+// The first row call of a process may come from many threads at once, the selection is
+// published with atomics. Without GCC builtins, call fnlGetSIMDLevel once before that.
+#if defined(__GNUC__)
+#define _fnlAtomicLoad(p, order) __atomic_load_n(p, __ATOMIC_##order)
+#define _fnlAtomicStore(p, v, order) __atomic_store_n(p, v, __ATOMIC_##order)
+#else
+#define _fnlAtomicLoad(p, order) (*(p))
+#define _fnlAtomicStore(p, v, order) (*(p) = (v))
+#endif
+
+static fnl_simd_level _fnlSimdLevelCap = FNL_SIMD_AVX2;
+static const _fnlSpanKernels *_fnlSpanKernelsActive = NULL;
+static fnl_simd_level _fnlSimdLevelActive = FNL_SIMD_NONE;
+
+static fnl_simd_level _fnlDetectSIMDLevel()
+{
+#if defined(FNL_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return FNL_SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return FNL_SIMD_SSE41;
+#endif
+    return FNL_SIMD_NONE;
+}
+
+static const _fnlSpanKernels *_fnlSelectSpanKernels()
+{
+    fnl_simd_level level = _fnlDetectSIMDLevel();
+    fnl_simd_level cap = _fnlAtomicLoad(&_fnlSimdLevelCap, RELAXED);
+    if (level > cap)
+        level = cap;
+
+    const _fnlSpanKernels *kernels = &_fnlSpanKernels_scalar;
+#if defined(FNL_SIMD_X86)
+    switch (level)
+    {
+    case FNL_SIMD_AVX2:
+        kernels = &_fnlSpanKernels_avx2;
+        break;
+    case FNL_SIMD_SSE41:
+        kernels = &_fnlSpanKernels_sse41;
+        break;
+    default:
+        break;
+    }
+#else
+    level = FNL_SIMD_NONE;
+#endif
+
+    // Threads racing here all select the same table.
+    _fnlAtomicStore(&_fnlSimdLevelActive, level, RELAXED);
+    _fnlAtomicStore(&_fnlSpanKernelsActive, kernels, RELEASE);
+    return kernels;
+}
+
+static inline const _fnlSpanKernels *_fnlGetSpanKernels()
+{
+    const _fnlSpanKernels *kernels = _fnlAtomicLoad(&_fnlSpanKernelsActive, ACQUIRE);
+    return kernels ? kernels : _fnlSelectSpanKernels();
+}
+
+// Span Gen
+//
+// Row variants of the above. Coordinates are processed in blocks of FNL_SPAN_BLOCK
+// samples, the noise and fractal type are switched on once per block and every
+// octave runs over the whole block before moving to the next one.
+
+static void _fnlTransformNoiseCoordinateSpan2D(fnl_state *state, FNLfloat *x, FNLfloat *y, int count)
+{
+    const FNLfloat frequency = state->frequency;
+    for (int i = 0; i < count; i++)
+    {
+        x[i] *= frequency;
+        y[i] *= frequency;
+    }
+
+    switch (state->noise_type)
+    {
+    case FNL_NOISE_OPENSIMPLEX2:
+    case FNL_NOISE_OPENSIMPLEX2S:
+    {
+        const FNLfloat SQRT3 = (FNLfloat)1.7320508075688772935274463415059;
+        const FNLfloat F2 = 0.5f * (SQRT3 - 1);
+        for (int i = 0; i < count; i++)
+        {
+            FNLfloat t = (x[i] + y[i]) * F2;
+            x[i] += t;
+            y[i] += t;
+        }
+    }
+    break;
+    default:
+        break;
+    }
+}
+
+static void _fnlTransformNoiseCoordinateSpan3D(fnl_state *state, FNLfloat *x, FNLfloat *y, FNLfloat *z, int count)
+{
+    const FNLfloat frequency = state->frequency;
+    for (int i = 0; i < count; i++)
+    {
+        x[i] *= frequency;
+        y[i] *= frequency;
+        z[i] *= frequency;
+    }
+
+    switch (state->rotation_type_3d)
+    {
+    case FNL_ROTATION_IMPROVE_XY_PLANES:
+        for (int i = 0; i < count; i++)
+        {
+            FNLfloat xy = x[i] + y[i];
+            FNLfloat s2 = xy * -(FNLfloat)0.211324865405187;
+            z[i] *= (FNLfloat)0.577350269189626;
+            x[i] += s2 - z[i];
+            y[i] = y[i] + s2 - z[i];
+            z[i] += xy * (FNLfloat)0.577350269189626;
+        }
+        break;
+    case FNL_ROTATION_IMPROVE_XZ_PLANES:
+        for (int i = 0; i < count; i++)
+        {
+            FNLfloat xz = x[i] + z[i];
+            FNLfloat s2 = xz * -(FNLfloat)0.211324865405187;
+            y[i] *= (FNLfloat)0.577350269189626;
+            x[i] += s2 - y[i];
+            z[i] += s2 - y[i];
+            y[i] += xz * (FNLfloat)0.577350269189626;
+        }
+        break;
+    default:
+        switch (state->noise_type)
+        {
+        case FNL_NOISE_OPENSIMPLEX2:
+        case FNL_NOISE_OPENSIMPLEX2S:
+        {
+            const FNLfloat R3 = (FNLfloat)(2.0 / 3.0);
+            for (int i = 0; i < count; i++)
+            {
+                FNLfloat r = (x[i] + y[i] + z[i]) * R3; // Rotation, not skew
+                x[i] = r - x[i];
+                y[i] = r - y[i];
+                z[i] = r - z[i];
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+}
+
+static void _fnlGenNoiseSpan2D(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    switch (state->noise_type)
+    {
+    case FNL_NOISE_OPENSIMPLEX2:
+        _fnlGetSpanKernels()->simplex2D(seed, x, y, out, count);
+        break;
+    case FNL_NOISE_OPENSIMPLEX2S:
+        for (int i = 0; i < count; i++) out[i] = _fnlSingleOpenSimplex2S2D(seed, x[i], y[i]);
+        break;
+    case FNL_NOISE_CELLULAR:
+        _fnlGetSpanKernels()->cellular2D(state, seed, x, y, out, count);
+        break;
+    case FNL_NOISE_PERLIN:
+        _fnlGetSpanKernels()->perlin2D(seed, x, y, out, count);
+        break;
+    case FNL_NOISE_VALUE_CUBIC:
+        for (int i = 0; i < count; i++) out[i] = _fnlSingleValueCubic2D(seed, x[i], y[i]);
+        break;
+    case FNL_NOISE_VALUE:
+        for (int i = 0; i < count; i++) out[i] = _fnlSingleValue2D(seed, x[i], y[i]);
+        break;
+    default:
+        for (int i = 0; i < count; i++) out[i] = 0;
+        break;
+    }
+}
+
+static void _fnlGenNoiseSpan3D(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    switch (state->noise_type)
+    {
+    case FNL_NOISE_OPENSIMPLEX2:
+        _fnlGetSpanKernels()->openSimplex23D(seed, x, y, z, out, count);
+        break;
+    case FNL_NOISE_OPENSIMPLEX2S:
+        for (int i = 0; i < count; i++) out[i] = _fnlSingleOpenSimplex2S3D(seed, x[i], y[i], z[i]);
+        break;
+    case FNL_NOISE_CELLULAR:
+        _fnlGetSpanKernels()->cellular3D(state, seed, x, y, z, out, count);
+        break;
+    case FNL_NOISE_PERLIN:
+        _fnlGetSpanKernels()->perlin3D(seed, x, y, z, out, count);
+        break;
+    case FNL_NOISE_VALUE_CUBIC:
+        for (int i = 0; i < count; i++) out[i] = _fnlSingleValueCubic3D(seed, x[i], y[i], z[i]);
+        break;
+    case FNL_NOISE_VALUE:
+        for (int i = 0; i < count; i++) out[i] = _fnlSingleValue3D(seed, x[i], y[i], z[i]);
+        break;
+    default:
+        for (int i = 0; i < count; i++) out[i] = 0;
+        break;
+    }
+}
+
+// Fractal spans keep a per sample amplitude, the weighted strength makes it depend on the noise value.
+
+static void _fnlGenFractalSpan2D(fnl_state *state, FNLfloat *x, FNLfloat *y, float *out, int count)
+{
+    if (state->fractal_type != FNL_FRACTAL_FBM && state->fractal_type != FNL_FRACTAL_RIDGED && state->fractal_type != FNL_FRACTAL_PINGPONG)
+    {
+        _fnlGenNoiseSpan2D(state, state->seed, x, y, out, count);
+        return;
+    }
+
+    int seed = state->seed;
+    float amp[FNL_SPAN_BLOCK];
+    float noise[FNL_SPAN_BLOCK];
+    const float bounding = _fnlCalculateFractalBounding(state);
+    const float weightedStrength = state->weighted_strength;
+    const float pingPongStrength = state->ping_pong_strength;
+    const float lacunarity = state->lacunarity;
+    const float gain = state->gain;
+
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = 0;
+        amp[i] = bounding;
+    }
+
+    for (int o = 0; o < state->octaves; o++)
+    {
+        _fnlGenNoiseSpan2D(state, seed++, x, y, noise, count);
+
+        switch (state->fractal_type)
+        {
+        default:
+        case FNL_FRACTAL_FBM:
+            for (int i = 0; i < count; i++)
+            {
+                out[i] += noise[i] * amp[i];
+                amp[i] *= _fnlLerp(1.0f, _fnlFastMin(noise[i] + 1, 2) * 0.5f, weightedStrength);
+            }
+            break;
+        case FNL_FRACTAL_RIDGED:
+            for (int i = 0; i < count; i++)
+            {
+                float n = _fnlFastAbs(noise[i]);
+                out[i] += (n * -2 + 1) * amp[i];
+                amp[i] *= _fnlLerp(1.0f, 1 - n, weightedStrength);
+            }
+            break;
+        case FNL_FRACTAL_PINGPONG:
+            for (int i = 0; i < count; i++)
+            {
+                float n = _fnlPingPong((noise[i] + 1) * pingPongStrength);
+                out[i] += (n - 0.5f) * 2 * amp[i];
+                amp[i] *= _fnlLerp(1.0f, n, weightedStrength);
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            x[i] *= lacunarity;
+            y[i] *= lacunarity;
+            amp[i] *= gain;
+        }
+    }
+}
+
+static void _fnlGenFractalSpan3D(fnl_state *state, FNLfloat *x, FNLfloat *y, FNLfloat *z, float *out, int count)
+{
+    if (state->fractal_type != FNL_FRACTAL_FBM && state->fractal_type != FNL_FRACTAL_RIDGED && state->fractal_type != FNL_FRACTAL_PINGPONG)
+    {
+        _fnlGenNoiseSpan3D(state, state->seed, x, y, z, out, count);
+        return;
+    }
+
+    int seed = state->seed;
+    float amp[FNL_SPAN_BLOCK];
+    float noise[FNL_SPAN_BLOCK];
+    const float bounding = _fnlCalculateFractalBounding(state);
+    const float weightedStrength = state->weighted_strength;
+    const float pingPongStrength = state->ping_pong_strength;
+    const float lacunarity = state->lacunarity;
+    const float gain = state->gain;
+
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = 0;
+        amp[i] = bounding;
+    }
+
+    for (int o = 0; o < state->octaves; o++)
+    {
+        _fnlGenNoiseSpan3D(state, seed++, x, y, z, noise, count);
+
+        switch (state->fractal_type)
+        {
+        default:
+        case FNL_FRACTAL_FBM:
+            for (int i = 0; i < count; i++)
+            {
+                out[i] += noise[i] * amp[i];
+                amp[i] *= _fnlLerp(1.0f, (noise[i] + 1) * 0.5f, weightedStrength);
+            }
+            break;
+        case FNL_FRACTAL_RIDGED:
+            for (int i = 0; i < count; i++)
+            {
+                float n = _fnlFastAbs(noise[i]);
+                out[i] += (n * -2 + 1) * amp[i];
+                amp[i] *= _fnlLerp(1.0f, 1 - n, weightedStrength);
+            }
+            break;
+        case FNL_FRACTAL_PINGPONG:
+            for (int i = 0; i < count; i++)
+            {
+                float n = _fnlPingPong((noise[i] + 1) * pingPongStrength);
+                out[i] += (n - 0.5f) * 2 * amp[i];
+                amp[i] *= _fnlLerp(1.0f, n, weightedStrength);
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            x[i] *= lacunarity;
+            y[i] *= lacunarity;
+            z[i] *= lacunarity;
+            amp[i] *= gain;
+        }
+    }
+}
+
 // Simplex/OpenSimplex2 Noise
 
 static float _fnlSingleSimplex2D(int seed, FNLfloat x, FNLfloat y)
@@ -2392,6 +2841,59 @@ float fnlGetNoise3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z)
     }
 }
 
+void fnlGetNoiseRow2D(fnl_state *state, float *out, int count, FNLfloat x, FNLfloat y, FNLfloat xstep)
+{
+    FNLfloat xs[FNL_SPAN_BLOCK];
+    FNLfloat ys[FNL_SPAN_BLOCK];
+
+    for (int done = 0; done < count; done += FNL_SPAN_BLOCK)
+    {
+        int n = count - done < FNL_SPAN_BLOCK ? count - done : FNL_SPAN_BLOCK;
+        for (int i = 0; i < n; i++)
+        {
+            xs[i] = x + (FNLfloat)(done + i) * xstep;
+            ys[i] = y;
+        }
+
+        _fnlTransformNoiseCoordinateSpan2D(state, xs, ys, n);
+        _fnlGenFractalSpan2D(state, xs, ys, out + done, n);
+    }
+}
+
+void fnlGetNoiseRow3D(fnl_state *state, float *out, int count, FNLfloat x, FNLfloat y, FNLfloat z, FNLfloat xstep)
+{
+    FNLfloat xs[FNL_SPAN_BLOCK];
+    FNLfloat ys[FNL_SPAN_BLOCK];
+    FNLfloat zs[FNL_SPAN_BLOCK];
+
+    for (int done = 0; done < count; done += FNL_SPAN_BLOCK)
+    {
+        int n = count - done < FNL_SPAN_BLOCK ? count - done : FNL_SPAN_BLOCK;
+        for (int i = 0; i < n; i++)
+        {
+            xs[i] = x + (FNLfloat)(done + i) * xstep;
+            ys[i] = y;
+            zs[i] = z;
+        }
+
+        _fnlTransformNoiseCoordinateSpan3D(state, xs, ys, zs, n);
+        _fnlGenFractalSpan3D(state, xs, ys, zs, out + done, n);
+    }
+}
+
+fnl_simd_level fnlGetSIMDLevel()
+{
+    _fnlGetSpanKernels();
+    return _fnlAtomicLoad(&_fnlSimdLevelActive, RELAXED);
+}
+
+fnl_simd_level fnlSetSIMDLevel(fnl_simd_level level)
+{
+    _fnlAtomicStore(&_fnlSimdLevelCap, level, RELAXED);
+    _fnlSelectSpanKernels();
+    return _fnlAtomicLoad(&_fnlSimdLevelActive, RELAXED);
+}
+
 void fnlDomainWarp2D(fnl_state *state, FNLfloat *x, FNLfloat *y)
 {
     switch (state->fractal_type)
@@ -0,0 +1,762 @@
+// x86 SIMD span kernels for fastnoise.h
+//
+// This file is a template, it has no include guard on purpose. fastnoise.h includes it
+// once per instruction set with FNLV_WIDTH set to 4 (SSE4.1) or 8 (AVX2), every function
+// gets the width's suffix through FNLV().
+//
+// Kernels follow their scalar counterparts operation by operation (no FMA, branches turned
+// into blends), so output is bit-identical to the scalar path as long as the scalar path is
+// not itself contracted into FMA by the compiler (e.g. -march=native on an FMA capable CPU),
+// in which case results differ by float rounding only.
+// Tails shorter than FNLV_WIDTH are handed to the scalar kernels.
+
+#if FNLV_WIDTH == 8
+
+#define fnlv_f __m256
+#define fnlv_i __m256i
+
+#define FNLV(name) name##_avx2
+#define FNLV_TARGET __attribute__((target("avx2")))
+
+#define fnlv_loadf(p) _mm256_loadu_ps(p)
+#define fnlv_storef(p, v) _mm256_storeu_ps(p, v)
+#define fnlv_storei(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define fnlv_setf(f) _mm256_set1_ps(f)
+#define fnlv_seti(i) _mm256_set1_epi32(i)
+#define fnlv_addf(a, b) _mm256_add_ps(a, b)
+#define fnlv_subf(a, b) _mm256_sub_ps(a, b)
+#define fnlv_mulf(a, b) _mm256_mul_ps(a, b)
+#define fnlv_divf(a, b) _mm256_div_ps(a, b)
+#define fnlv_minf(a, b) _mm256_min_ps(a, b)
+#define fnlv_maxf(a, b) _mm256_max_ps(a, b)
+#define fnlv_xorf(a, b) _mm256_xor_ps(a, b)
+#define fnlv_andf(a, b) _mm256_and_ps(a, b)
+#define fnlv_orf(a, b) _mm256_or_ps(a, b)
+#define fnlv_andnotf(a, b) _mm256_andnot_ps(a, b)
+#define fnlv_ltf(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define fnlv_lef(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define fnlv_gtf(a, b) _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define fnlv_gef(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define fnlv_blendf(a, b, mask) _mm256_blendv_ps(a, b, mask)
+#define fnlv_addi(a, b) _mm256_add_epi32(a, b)
+#define fnlv_subi(a, b) _mm256_sub_epi32(a, b)
+#define fnlv_muli(a, b) _mm256_mullo_epi32(a, b)
+#define fnlv_xori(a, b) _mm256_xor_si256(a, b)
+#define fnlv_andi(a, b) _mm256_and_si256(a, b)
+#define fnlv_ori(a, b) _mm256_or_si256(a, b)
+#define fnlv_srai(a, n) _mm256_srai_epi32(a, n)
+#define fnlv_slli(a, n) _mm256_slli_epi32(a, n)
+#define fnlv_blendi(a, b, mask) _mm256_blendv_epi8(a, b, _mm256_castps_si256(mask))
+#define fnlv_itof(i) _mm256_cvtepi32_ps(i)
+#define fnlv_ftoi(f) _mm256_cvttps_epi32(f)
+#define fnlv_castitof(i) _mm256_castsi256_ps(i)
+#define fnlv_castftoi(f) _mm256_castps_si256(f)
+#define fnlv_gather(table, idx) _mm256_i32gather_ps(table, idx, 4)
+
+#elif FNLV_WIDTH == 4
+
+#define fnlv_f __m128
+#define fnlv_i __m128i
+
+#define FNLV(name) name##_sse41
+#define FNLV_TARGET __attribute__((target("sse4.1")))
+
+#define fnlv_loadf(p) _mm_loadu_ps(p)
+#define fnlv_storef(p, v) _mm_storeu_ps(p, v)
+#define fnlv_storei(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define fnlv_setf(f) _mm_set1_ps(f)
+#define fnlv_seti(i) _mm_set1_epi32(i)
+#define fnlv_addf(a, b) _mm_add_ps(a, b)
+#define fnlv_subf(a, b) _mm_sub_ps(a, b)
+#define fnlv_mulf(a, b) _mm_mul_ps(a, b)
+#define fnlv_divf(a, b) _mm_div_ps(a, b)
+#define fnlv_minf(a, b) _mm_min_ps(a, b)
+#define fnlv_maxf(a, b) _mm_max_ps(a, b)
+#define fnlv_xorf(a, b) _mm_xor_ps(a, b)
+#define fnlv_andf(a, b) _mm_and_ps(a, b)
+#define fnlv_orf(a, b) _mm_or_ps(a, b)
+#define fnlv_andnotf(a, b) _mm_andnot_ps(a, b)
+#define fnlv_ltf(a, b) _mm_cmplt_ps(a, b)
+#define fnlv_lef(a, b) _mm_cmple_ps(a, b)
+#define fnlv_gtf(a, b) _mm_cmpgt_ps(a, b)
+#define fnlv_gef(a, b) _mm_cmpge_ps(a, b)
+#define fnlv_blendf(a, b, mask) _mm_blendv_ps(a, b, mask)
+#define fnlv_addi(a, b) _mm_add_epi32(a, b)
+#define fnlv_subi(a, b) _mm_sub_epi32(a, b)
+#define fnlv_muli(a, b) _mm_mullo_epi32(a, b)
+#define fnlv_xori(a, b) _mm_xor_si128(a, b)
+#define fnlv_andi(a, b) _mm_and_si128(a, b)
+#define fnlv_ori(a, b) _mm_or_si128(a, b)
+#define fnlv_srai(a, n) _mm_srai_epi32(a, n)
+#define fnlv_slli(a, n) _mm_slli_epi32(a, n)
+#define fnlv_blendi(a, b, mask) _mm_blendv_epi8(a, b, _mm_castps_si128(mask))
+#define fnlv_itof(i) _mm_cvtepi32_ps(i)
+#define fnlv_ftoi(f) _mm_cvttps_epi32(f)
+#define fnlv_castitof(i) _mm_castsi128_ps(i)
+#define fnlv_castftoi(f) _mm_castps_si128(f)
+#define fnlv_gather(table, idx) FNLV(_fnlvGather)(table, idx)
+
+// SSE has no gather, lanes are looked up one by one.
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvGather)(const float *table, fnlv_i idx)
+{
+    return _mm_setr_ps(table[_mm_extract_epi32(idx, 0)], table[_mm_extract_epi32(idx, 1)],
+                       table[_mm_extract_epi32(idx, 2)], table[_mm_extract_epi32(idx, 3)]);
+}
+
+#else
+#error "FNLV_WIDTH must be 4 or 8"
+#endif
+
+// Utilities
+
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvNeg)(fnlv_f f) { return fnlv_xorf(f, fnlv_setf(-0.0f)); }
+
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvFastAbs)(fnlv_f f) { return fnlv_blendf(f, FNLV(_fnlvNeg)(f), fnlv_ltf(f, fnlv_setf(0))); }
+
+// _fnlFastFloor: truncate, then subtract one for negative input (also for negative integers).
+static inline FNLV_TARGET fnlv_i FNLV(_fnlvFastFloor)(fnlv_f f)
+{
+    return fnlv_addi(fnlv_ftoi(f), fnlv_castftoi(fnlv_ltf(f, fnlv_setf(0))));
+}
+
+static inline FNLV_TARGET fnlv_i FNLV(_fnlvFastRound)(fnlv_f f)
+{
+    return fnlv_ftoi(fnlv_addf(f, fnlv_blendf(fnlv_setf(-0.5f), fnlv_setf(0.5f), fnlv_gef(f, fnlv_setf(0)))));
+}
+
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvLerp)(fnlv_f a, fnlv_f b, fnlv_f t) { return fnlv_addf(a, fnlv_mulf(t, fnlv_subf(b, a))); }
+
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvInterpQuintic)(fnlv_f t)
+{
+    fnlv_f inner = fnlv_addf(fnlv_mulf(t, fnlv_subf(fnlv_mulf(t, fnlv_setf(6)), fnlv_setf(15))), fnlv_setf(10));
+    return fnlv_mulf(fnlv_mulf(fnlv_mulf(t, t), t), inner);
+}
+
+// (a * a) * (a * a) * g, or 0 where a <= 0
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvFalloff)(fnlv_f a, fnlv_f g)
+{
+    fnlv_f a2 = fnlv_mulf(a, a);
+    return fnlv_blendf(fnlv_mulf(fnlv_mulf(a2, a2), g), fnlv_setf(0), fnlv_lef(a, fnlv_setf(0)));
+}
+
+// Hashing
+
+static inline FNLV_TARGET fnlv_i FNLV(_fnlvHash2D)(fnlv_i seed, fnlv_i xPrimed, fnlv_i yPrimed)
+{
+    fnlv_i hash = fnlv_xori(fnlv_xori(seed, xPrimed), yPrimed);
+    return fnlv_muli(hash, fnlv_seti(0x27d4eb2d));
+}
+
+static inline FNLV_TARGET fnlv_i FNLV(_fnlvHash3D)(fnlv_i seed, fnlv_i xPrimed, fnlv_i yPrimed, fnlv_i zPrimed)
+{
+    fnlv_i hash = fnlv_xori(fnlv_xori(fnlv_xori(seed, xPrimed), yPrimed), zPrimed);
+    return fnlv_muli(hash, fnlv_seti(0x27d4eb2d));
+}
+
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvGradCoord2D)(fnlv_i seed, fnlv_i xPrimed, fnlv_i yPrimed, fnlv_f xd, fnlv_f yd)
+{
+    fnlv_i hash = FNLV(_fnlvHash2D)(seed, xPrimed, yPrimed);
+    hash = fnlv_xori(hash, fnlv_srai(hash, 15));
+    hash = fnlv_andi(hash, fnlv_seti(127 << 1));
+
+    // hash is even, so hash | 1 is the next element
+    fnlv_f xg = fnlv_gather(GRADIENTS_2D, hash);
+    fnlv_f yg = fnlv_gather(GRADIENTS_2D + 1, hash);
+    return fnlv_addf(fnlv_mulf(xd, xg), fnlv_mulf(yd, yg));
+}
+
+static inline FNLV_TARGET fnlv_f FNLV(_fnlvGradCoord3D)(fnlv_i seed, fnlv_i xPrimed, fnlv_i yPrimed, fnlv_i zPrimed, fnlv_f xd, fnlv_f yd, fnlv_f zd)
+{
+    fnlv_i hash = FNLV(_fnlvHash3D)(seed, xPrimed, yPrimed, zPrimed);
+    hash = fnlv_xori(hash, fnlv_srai(hash, 15));
+    hash = fnlv_andi(hash, fnlv_seti(63 << 2));
+
+    fnlv_f xg = fnlv_gather(GRADIENTS_3D, hash);
+    fnlv_f yg = fnlv_gather(GRADIENTS_3D + 1, hash);
+    fnlv_f zg = fnlv_gather(GRADIENTS_3D + 2, hash);
+    return fnlv_addf(fnlv_addf(fnlv_mulf(xd, xg), fnlv_mulf(yd, yg)), fnlv_mulf(zd, zg));
+}
+
+// Simplex/OpenSimplex2 Noise
+
+static FNLV_TARGET void FNLV(_fnlSimplexSpan2D)(int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    const float SQRT3 = 1.7320508075688772935274463415059f;
+    const float G2 = (3 - SQRT3) / 6;
+
+    const fnlv_f vG2 = fnlv_setf(G2);
+    const fnlv_f vG2m1 = fnlv_setf((float)G2 - 1);
+    const fnlv_f vG2x2m1 = fnlv_setf(2 * (float)G2 - 1);
+    const fnlv_f vCt = fnlv_setf((float)(2 * (1 - 2 * G2) * (1 / G2 - 2)));
+    const fnlv_f vCa = fnlv_setf((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)));
+    const fnlv_f vHalf = fnlv_setf(0.5f);
+    const fnlv_i vSeed = fnlv_seti(seed);
+    const fnlv_i vPrimeX = fnlv_seti(PRIME_X);
+    const fnlv_i vPrimeY = fnlv_seti(PRIME_Y);
+
+    int n = 0;
+    for (; n + FNLV_WIDTH <= count; n += FNLV_WIDTH)
+    {
+        fnlv_f vx = fnlv_loadf(x + n);
+        fnlv_f vy = fnlv_loadf(y + n);
+
+        fnlv_i i = FNLV(_fnlvFastFloor)(vx);
+        fnlv_i j = FNLV(_fnlvFastFloor)(vy);
+        fnlv_f xi = fnlv_subf(vx, fnlv_itof(i));
+        fnlv_f yi = fnlv_subf(vy, fnlv_itof(j));
+
+        fnlv_f t = fnlv_mulf(fnlv_addf(xi, yi), vG2);
+        fnlv_f x0 = fnlv_subf(xi, t);
+        fnlv_f y0 = fnlv_subf(yi, t);
+
+        i = fnlv_muli(i, vPrimeX);
+        j = fnlv_muli(j, vPrimeY);
+
+        fnlv_f a = fnlv_subf(fnlv_subf(vHalf, fnlv_mulf(x0, x0)), fnlv_mulf(y0, y0));
+        fnlv_f n0 = FNLV(_fnlvFalloff)(a, FNLV(_fnlvGradCoord2D)(vSeed, i, j, x0, y0));
+
+        fnlv_f c = fnlv_addf(fnlv_mulf(vCt, t), fnlv_addf(vCa, a));
+        fnlv_f x2 = fnlv_addf(x0, vG2x2m1);
+        fnlv_f y2 = fnlv_addf(y0, vG2x2m1);
+        fnlv_f n2 = FNLV(_fnlvFalloff)(c, FNLV(_fnlvGradCoord2D)(vSeed, fnlv_addi(i, vPrimeX), fnlv_addi(j, vPrimeY), x2, y2));
+
+        // y0 > x0 picks the upper triangle
+        fnlv_f upper = fnlv_gtf(y0, x0);
+        fnlv_f x1 = fnlv_blendf(fnlv_addf(x0, vG2m1), fnlv_addf(x0, vG2), upper);
+        fnlv_f y1 = fnlv_blendf(fnlv_addf(y0, vG2), fnlv_addf(y0, vG2m1), upper);
+        fnlv_i i1 = fnlv_blendi(fnlv_addi(i, vPrimeX), i, upper);
+        fnlv_i j1 = fnlv_blendi(j, fnlv_addi(j, vPrimeY), upper);
+        fnlv_f b = fnlv_subf(fnlv_subf(vHalf, fnlv_mulf(x1, x1)), fnlv_mulf(y1, y1));
+        fnlv_f n1 = FNLV(_fnlvFalloff)(b, FNLV(_fnlvGradCoord2D)(vSeed, i1, j1, x1, y1));
+
+        fnlv_storef(out + n, fnlv_mulf(fnlv_addf(fnlv_addf(n0, n1), n2), fnlv_setf(99.83685446303647f)));
+    }
+
+    for (; n < count; n++)
+        out[n] = _fnlSingleSimplex2D(seed, x[n], y[n]);
+}
+
+static FNLV_TARGET void FNLV(_fnlOpenSimplex2Span3D)(int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    const fnlv_f vZero = fnlv_setf(0);
+    const fnlv_f vHalf = fnlv_setf(0.5f);
+    const fnlv_i vOne = fnlv_seti(1);
+    const fnlv_i vPrimeX = fnlv_seti(PRIME_X);
+    const fnlv_i vPrimeY = fnlv_seti(PRIME_Y);
+    const fnlv_i vPrimeZ = fnlv_seti(PRIME_Z);
+
+    int n = 0;
+    for (; n + FNLV_WIDTH <= count; n += FNLV_WIDTH)
+    {
+        fnlv_f vx = fnlv_loadf(x + n);
+        fnlv_f vy = fnlv_loadf(y + n);
+        fnlv_f vz = fnlv_loadf(z + n);
+        fnlv_i vSeed = fnlv_seti(seed);
+
+        fnlv_i i = FNLV(_fnlvFastRound)(vx);
+        fnlv_i j = FNLV(_fnlvFastRound)(vy);
+        fnlv_i k = FNLV(_fnlvFastRound)(vz);
+        fnlv_f x0 = fnlv_subf(vx, fnlv_itof(i));
+        fnlv_f y0 = fnlv_subf(vy, fnlv_itof(j));
+        fnlv_f z0 = fnlv_subf(vz, fnlv_itof(k));
+
+        fnlv_i xNSign = fnlv_ori(fnlv_ftoi(fnlv_subf(fnlv_setf(-1.0f), x0)), vOne);
+        fnlv_i yNSign = fnlv_ori(fnlv_ftoi(fnlv_subf(fnlv_setf(-1.0f), y0)), vOne);
+        fnlv_i zNSign = fnlv_ori(fnlv_ftoi(fnlv_subf(fnlv_setf(-1.0f), z0)), vOne);
+
+        fnlv_f ax0 = fnlv_mulf(fnlv_itof(xNSign), FNLV(_fnlvNeg)(x0));
+        fnlv_f ay0 = fnlv_mulf(fnlv_itof(yNSign), FNLV(_fnlvNeg)(y0));
+        fnlv_f az0 = fnlv_mulf(fnlv_itof(zNSign), FNLV(_fnlvNeg)(z0));
+
+        i = fnlv_muli(i, vPrimeX);
+        j = fnlv_muli(j, vPrimeY);
+        k = fnlv_muli(k, vPrimeZ);
+
+        fnlv_f value = vZero;
+        fnlv_f a = fnlv_subf(fnlv_subf(fnlv_setf(0.6f), fnlv_mulf(x0, x0)), fnlv_addf(fnlv_mulf(y0, y0), fnlv_mulf(z0, z0)));
+
+        for (int l = 0; ; l++)
+        {
+            fnlv_f a2 = fnlv_mulf(a, a);
+            fnlv_f contrib = fnlv_mulf(fnlv_mulf(a2, a2), FNLV(_fnlvGradCoord3D)(vSeed, i, j, k, x0, y0, z0));
+            value = fnlv_blendf(value, fnlv_addf(value, contrib), fnlv_gtf(a, vZero));
+
+            // Exactly one axis steps towards the second lattice point, in x, y, z priority order.
+            fnlv_f stepX = fnlv_andf(fnlv_gef(ax0, ay0), fnlv_gef(ax0, az0));
+            fnlv_f stepY = fnlv_andnotf(stepX, fnlv_andf(fnlv_gtf(ay0, ax0), fnlv_gef(ay0, az0)));
+            fnlv_f stepZ = fnlv_andnotf(fnlv_orf(stepX, stepY), fnlv_castitof(fnlv_seti(-1)));
+
+            fnlv_f x1 = fnlv_blendf(x0, fnlv_addf(x0, fnlv_itof(xNSign)), stepX);
+            fnlv_f y1 = fnlv_blendf(y0, fnlv_addf(y0, fnlv_itof(yNSign)), stepY);
+            fnlv_f z1 = fnlv_blendf(z0, fnlv_addf(z0, fnlv_itof(zNSign)), stepZ);
+
+            fnlv_f bStep = fnlv_mulf(fnlv_itof(fnlv_slli(zNSign, 1)), z1);
+            bStep = fnlv_blendf(bStep, fnlv_mulf(fnlv_itof(fnlv_slli(yNSign, 1)), y1), stepY);
+            bStep = fnlv_blendf(bStep, fnlv_mulf(fnlv_itof(fnlv_slli(xNSign, 1)), x1), stepX);
+            fnlv_f b = fnlv_subf(fnlv_addf(a, fnlv_setf(1)), bStep);
+
+            fnlv_i i1 = fnlv_blendi(i, fnlv_subi(i, fnlv_muli(xNSign, vPrimeX)), stepX);
+            fnlv_i j1 = fnlv_blendi(j, fnlv_subi(j, fnlv_muli(yNSign, vPrimeY)), stepY);
+            fnlv_i k1 = fnlv_blendi(k, fnlv_subi(k, fnlv_muli(zNSign, vPrimeZ)), stepZ);
+
+            fnlv_f b2 = fnlv_mulf(b, b);
+            contrib = fnlv_mulf(fnlv_mulf(b2, b2), FNLV(_fnlvGradCoord3D)(vSeed, i1, j1, k1, x1, y1, z1));
+            value = fnlv_blendf(value, fnlv_addf(value, contrib), fnlv_gtf(b, vZero));
+
+            if (l == 1)
+                break;
+
+            ax0 = fnlv_subf(vHalf, ax0);
+            ay0 = fnlv_subf(vHalf, ay0);
+            az0 = fnlv_subf(vHalf, az0);
+
+            x0 = fnlv_mulf(fnlv_itof(xNSign), ax0);
+            y0 = fnlv_mulf(fnlv_itof(yNSign), ay0);
+            z0 = fnlv_mulf(fnlv_itof(zNSign), az0);
+
+            a = fnlv_addf(a, fnlv_subf(fnlv_subf(fnlv_setf(0.75f), ax0), fnlv_addf(ay0, az0)));
+
+            i = fnlv_addi(i, fnlv_andi(fnlv_srai(xNSign, 1), vPrimeX));
+            j = fnlv_addi(j, fnlv_andi(fnlv_srai(yNSign, 1), vPrimeY));
+            k = fnlv_addi(k, fnlv_andi(fnlv_srai(zNSign, 1), vPrimeZ));
+
+            xNSign = fnlv_subi(fnlv_seti(0), xNSign);
+            yNSign = fnlv_subi(fnlv_seti(0), yNSign);
+            zNSign = fnlv_subi(fnlv_seti(0), zNSign);
+
+            vSeed = fnlv_seti(~seed);
+        }
+
+        fnlv_storef(out + n, fnlv_mulf(value, fnlv_setf(32.69428253173828125f)));
+    }
+
+    for (; n < count; n++)
+        out[n] = _fnlSingleOpenSimplex23D(seed, x[n], y[n], z[n]);
+}
+
+// Perlin Noise
+
+static FNLV_TARGET void FNLV(_fnlPerlinSpan2D)(int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    const fnlv_f vOne = fnlv_setf(1);
+    const fnlv_i vSeed = fnlv_seti(seed);
+    const fnlv_i vPrimeX = fnlv_seti(PRIME_X);
+    const fnlv_i vPrimeY = fnlv_seti(PRIME_Y);
+
+    int n = 0;
+    for (; n + FNLV_WIDTH <= count; n += FNLV_WIDTH)
+    {
+        fnlv_f vx = fnlv_loadf(x + n);
+        fnlv_f vy = fnlv_loadf(y + n);
+
+        fnlv_i x0 = FNLV(_fnlvFastFloor)(vx);
+        fnlv_i y0 = FNLV(_fnlvFastFloor)(vy);
+
+        fnlv_f xd0 = fnlv_subf(vx, fnlv_itof(x0));
+        fnlv_f yd0 = fnlv_subf(vy, fnlv_itof(y0));
+        fnlv_f xd1 = fnlv_subf(xd0, vOne);
+        fnlv_f yd1 = fnlv_subf(yd0, vOne);
+
+        fnlv_f xs = FNLV(_fnlvInterpQuintic)(xd0);
+        fnlv_f ys = FNLV(_fnlvInterpQuintic)(yd0);
+
+        x0 = fnlv_muli(x0, vPrimeX);
+        y0 = fnlv_muli(y0, vPrimeY);
+        fnlv_i x1 = fnlv_addi(x0, vPrimeX);
+        fnlv_i y1 = fnlv_addi(y0, vPrimeY);
+
+        fnlv_f xf0 = FNLV(_fnlvLerp)(FNLV(_fnlvGradCoord2D)(vSeed, x0, y0, xd0, yd0), FNLV(_fnlvGradCoord2D)(vSeed, x1, y0, xd1, yd0), xs);
+        fnlv_f xf1 = FNLV(_fnlvLerp)(FNLV(_fnlvGradCoord2D)(vSeed, x0, y1, xd0, yd1), FNLV(_fnlvGradCoord2D)(vSeed, x1, y1, xd1, yd1), xs);
+
+        fnlv_storef(out + n, fnlv_mulf(FNLV(_fnlvLerp)(xf0, xf1, ys), fnlv_setf(1.4247691104677813f)));
+    }
+
+    for (; n < count; n++)
+        out[n] = _fnlSinglePerlin2D(seed, x[n], y[n]);
+}
+
+static FNLV_TARGET void FNLV(_fnlPerlinSpan3D)(int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    const fnlv_f vOne = fnlv_setf(1);
+    const fnlv_i vSeed = fnlv_seti(seed);
+    const fnlv_i vPrimeX = fnlv_seti(PRIME_X);
+    const fnlv_i vPrimeY = fnlv_seti(PRIME_Y);
+    const fnlv_i vPrimeZ = fnlv_seti(PRIME_Z);
+
+    int n = 0;
+    for (; n + FNLV_WIDTH <= count; n += FNLV_WIDTH)
+    {
+        fnlv_f vx = fnlv_loadf(x + n);
+        fnlv_f vy = fnlv_loadf(y + n);
+        fnlv_f vz = fnlv_loadf(z + n);
+
+        fnlv_i x0 = FNLV(_fnlvFastFloor)(vx);
+        fnlv_i y0 = FNLV(_fnlvFastFloor)(vy);
+        fnlv_i z0 = FNLV(_fnlvFastFloor)(vz);
+
+        fnlv_f xd0 = fnlv_subf(vx, fnlv_itof(x0));
+        fnlv_f yd0 = fnlv_subf(vy, fnlv_itof(y0));
+        fnlv_f zd0 = fnlv_subf(vz, fnlv_itof(z0));
+        fnlv_f xd1 = fnlv_subf(xd0, vOne);
+        fnlv_f yd1 = fnlv_subf(yd0, vOne);
+        fnlv_f zd1 = fnlv_subf(zd0, vOne);
+
+        fnlv_f xs = FNLV(_fnlvInterpQuintic)(xd0);
+        fnlv_f ys = FNLV(_fnlvInterpQuintic)(yd0);
+        fnlv_f zs = FNLV(_fnlvInterpQuintic)(zd0);
+
+        x0 = fnlv_muli(x0, vPrimeX);
+        y0 = fnlv_muli(y0, vPrimeY);
+        z0 = fnlv_muli(z0, vPrimeZ);
+        fnlv_i x1 = fnlv_addi(x0, vPrimeX);
+        fnlv_i y1 = fnlv_addi(y0, vPrimeY);
+        fnlv_i z1 = fnlv_addi(z0, vPrimeZ);
+
+        fnlv_f xf00 = FNLV(_fnlvLerp)(FNLV(_fnlvGradCoord3D)(vSeed, x0, y0, z0, xd0, yd0, zd0), FNLV(_fnlvGradCoord3D)(vSeed, x1, y0, z0, xd1, yd0, zd0), xs);
+        fnlv_f xf10 = FNLV(_fnlvLerp)(FNLV(_fnlvGradCoord3D)(vSeed, x0, y1, z0, xd0, yd1, zd0), FNLV(_fnlvGradCoord3D)(vSeed, x1, y1, z0, xd1, yd1, zd0), xs);
+        fnlv_f xf01 = FNLV(_fnlvLerp)(FNLV(_fnlvGradCoord3D)(vSeed, x0, y0, z1, xd0, yd0, zd1), FNLV(_fnlvGradCoord3D)(vSeed, x1, y0, z1, xd1, yd0, zd1), xs);
+        fnlv_f xf11 = FNLV(_fnlvLerp)(FNLV(_fnlvGradCoord3D)(vSeed, x0, y1, z1, xd0, yd1, zd1), FNLV(_fnlvGradCoord3D)(vSeed, x1, y1, z1, xd1, yd1, zd1), xs);
+
+        fnlv_f yf0 = FNLV(_fnlvLerp)(xf00, xf10, ys);
+        fnlv_f yf1 = FNLV(_fnlvLerp)(xf01, xf11, ys);
+
+        fnlv_storef(out + n, fnlv_mulf(FNLV(_fnlvLerp)(yf0, yf1, zs), fnlv_setf(0.964921414852142333984375f)));
+    }
+
+    for (; n < count; n++)
+        out[n] = _fnlSinglePerlin3D(seed, x[n], y[n], z[n]);
+}
+
+// Cellular Noise
+//
+// The 3x3(x3) neighbourhood walk is specialised per distance function: the span entry point
+// switches once and calls an always inlined body with the function as a constant. It leaves
+// distance0 in out, distance1 and the closest hash in block buffers, and the return type is
+// applied afterwards in its own pass, again with a single switch per block.
+
+static inline __attribute__((always_inline)) FNLV_TARGET fnlv_f FNLV(_fnlvCellularDistance)(fnl_cellular_distance_func distanceFunc, fnlv_f vecX, fnlv_f vecY)
+{
+    switch (distanceFunc)
+    {
+    default:
+        return fnlv_addf(fnlv_mulf(vecX, vecX), fnlv_mulf(vecY, vecY));
+    case FNL_CELLULAR_DISTANCE_MANHATTAN:
+        return fnlv_addf(FNLV(_fnlvFastAbs)(vecX), FNLV(_fnlvFastAbs)(vecY));
+    case FNL_CELLULAR_DISTANCE_HYBRID:
+        return fnlv_addf(fnlv_addf(FNLV(_fnlvFastAbs)(vecX), FNLV(_fnlvFastAbs)(vecY)),
+                         fnlv_addf(fnlv_mulf(vecX, vecX), fnlv_mulf(vecY, vecY)));
+    }
+}
+
+static inline __attribute__((always_inline)) FNLV_TARGET fnlv_f FNLV(_fnlvCellularDistance3D)(fnl_cellular_distance_func distanceFunc, fnlv_f vecX, fnlv_f vecY, fnlv_f vecZ)
+{
+    switch (distanceFunc)
+    {
+    default:
+        return fnlv_addf(fnlv_addf(fnlv_mulf(vecX, vecX), fnlv_mulf(vecY, vecY)), fnlv_mulf(vecZ, vecZ));
+    case FNL_CELLULAR_DISTANCE_MANHATTAN:
+        return fnlv_addf(fnlv_addf(FNLV(_fnlvFastAbs)(vecX), FNLV(_fnlvFastAbs)(vecY)), FNLV(_fnlvFastAbs)(vecZ));
+    case FNL_CELLULAR_DISTANCE_HYBRID:
+        return fnlv_addf(fnlv_addf(fnlv_addf(FNLV(_fnlvFastAbs)(vecX), FNLV(_fnlvFastAbs)(vecY)), FNLV(_fnlvFastAbs)(vecZ)),
+                         fnlv_addf(fnlv_addf(fnlv_mulf(vecX, vecX), fnlv_mulf(vecY, vecY)), fnlv_mulf(vecZ, vecZ)));
+    }
+}
+
+static inline __attribute__((always_inline)) FNLV_TARGET int FNLV(_fnlCellularNeighbours2D)(fnl_cellular_distance_func distanceFunc, int seed, float jitter, const FNLfloat *x, const FNLfloat *y, float *distance0, float *distance1, int *closestHash, int count)
+{
+    const fnlv_f vJitter = fnlv_setf(jitter);
+    const fnlv_i vSeed = fnlv_seti(seed);
+    const fnlv_i vPrimeX = fnlv_seti(PRIME_X);
+    const fnlv_i vPrimeY = fnlv_seti(PRIME_Y);
+    const fnlv_i vOne = fnlv_seti(1);
+
+    int n = 0;
+    for (; n + FNLV_WIDTH <= count; n += FNLV_WIDTH)
+    {
+        fnlv_f vx = fnlv_loadf(x + n);
+        fnlv_f vy = fnlv_loadf(y + n);
+
+        fnlv_i xr = FNLV(_fnlvFastRound)(vx);
+        fnlv_i yr = FNLV(_fnlvFastRound)(vy);
+
+        fnlv_f d0 = fnlv_setf(FLT_MAX);
+        fnlv_f d1 = fnlv_setf(FLT_MAX);
+        fnlv_i closest = fnlv_seti(0);
+
+        fnlv_i xi = fnlv_subi(xr, vOne);
+        fnlv_i xPrimed = fnlv_muli(xi, vPrimeX);
+        fnlv_i yPrimedBase = fnlv_muli(fnlv_subi(yr, vOne), vPrimeY);
+
+        for (int cx = 0; cx < 3; cx++)
+        {
+            fnlv_f xd = fnlv_subf(fnlv_itof(xi), vx);
+            fnlv_i yi = fnlv_subi(yr, vOne);
+            fnlv_i yPrimed = yPrimedBase;
+
+            for (int cy = 0; cy < 3; cy++)
+            {
+                fnlv_i hash = FNLV(_fnlvHash2D)(vSeed, xPrimed, yPrimed);
+                fnlv_i idx = fnlv_andi(hash, fnlv_seti(255 << 1));
+
+                fnlv_f vecX = fnlv_addf(xd, fnlv_mulf(fnlv_gather(RAND_VECS_2D, idx), vJitter));
+                fnlv_f vecY = fnlv_addf(fnlv_subf(fnlv_itof(yi), vy), fnlv_mulf(fnlv_gather(RAND_VECS_2D + 1, idx), vJitter));
+
+                fnlv_f newDistance = FNLV(_fnlvCellularDistance)(distanceFunc, vecX, vecY);
+
+                d1 = fnlv_maxf(fnlv_minf(d1, newDistance), d0);
+                fnlv_f closer = fnlv_ltf(newDistance, d0);
+                d0 = fnlv_blendf(d0, newDistance, closer);
+                closest = fnlv_blendi(closest, hash, closer);
+
+                yi = fnlv_addi(yi, vOne);
+                yPrimed = fnlv_addi(yPrimed, vPrimeY);
+            }
+            xi = fnlv_addi(xi, vOne);
+            xPrimed = fnlv_addi(xPrimed, vPrimeX);
+        }
+
+        fnlv_storef(distance0 + n, d0);
+        fnlv_storef(distance1 + n, d1);
+        fnlv_storei(closestHash + n, closest);
+    }
+    return n;
+}
+
+static inline __attribute__((always_inline)) FNLV_TARGET int FNLV(_fnlCellularNeighbours3D)(fnl_cellular_distance_func distanceFunc, int seed, float jitter, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *distance0, float *distance1, int *closestHash, int count)
+{
+    const fnlv_f vJitter = fnlv_setf(jitter);
+    const fnlv_i vSeed = fnlv_seti(seed);
+    const fnlv_i vPrimeX = fnlv_seti(PRIME_X);
+    const fnlv_i vPrimeY = fnlv_seti(PRIME_Y);
+    const fnlv_i vPrimeZ = fnlv_seti(PRIME_Z);
+    const fnlv_i vOne = fnlv_seti(1);
+
+    int n = 0;
+    for (; n + FNLV_WIDTH <= count; n += FNLV_WIDTH)
+    {
+        fnlv_f vx = fnlv_loadf(x + n);
+        fnlv_f vy = fnlv_loadf(y + n);
+        fnlv_f vz = fnlv_loadf(z + n);
+
+        fnlv_i xr = FNLV(_fnlvFastRound)(vx);
+        fnlv_i yr = FNLV(_fnlvFastRound)(vy);
+        fnlv_i zr = FNLV(_fnlvFastRound)(vz);
+
+        fnlv_f d0 = fnlv_setf(FLT_MAX);
+        fnlv_f d1 = fnlv_setf(FLT_MAX);
+        fnlv_i closest = fnlv_seti(0);
+
+        fnlv_i xi = fnlv_subi(xr, vOne);
+        fnlv_i xPrimed = fnlv_muli(xi, vPrimeX);
+        fnlv_i yPrimedBase = fnlv_muli(fnlv_subi(yr, vOne), vPrimeY);
+        fnlv_i zPrimedBase = fnlv_muli(fnlv_subi(zr, vOne), vPrimeZ);
+
+        for (int cx = 0; cx < 3; cx++)
+        {
+            fnlv_f xd = fnlv_subf(fnlv_itof(xi), vx);
+            fnlv_i yi = fnlv_subi(yr, vOne);
+            fnlv_i yPrimed = yPrimedBase;
+
+            for (int cy = 0; cy < 3; cy++)
+            {
+                fnlv_f yd = fnlv_subf(fnlv_itof(yi), vy);
+                fnlv_i zi = fnlv_subi(zr, vOne);
+                fnlv_i zPrimed = zPrimedBase;
+
+                for (int cz = 0; cz < 3; cz++)
+                {
+                    fnlv_i hash = FNLV(_fnlvHash3D)(vSeed, xPrimed, yPrimed, zPrimed);
+                    fnlv_i idx = fnlv_andi(hash, fnlv_seti(255 << 2));
+
+                    fnlv_f vecX = fnlv_addf(xd, fnlv_mulf(fnlv_gather(RAND_VECS_3D, idx), vJitter));
+                    fnlv_f vecY = fnlv_addf(yd, fnlv_mulf(fnlv_gather(RAND_VECS_3D + 1, idx), vJitter));
+                    fnlv_f vecZ = fnlv_addf(fnlv_subf(fnlv_itof(zi), vz), fnlv_mulf(fnlv_gather(RAND_VECS_3D + 2, idx), vJitter));
+
+                    fnlv_f newDistance = FNLV(_fnlvCellularDistance3D)(distanceFunc, vecX, vecY, vecZ);
+
+                    d1 = fnlv_maxf(fnlv_minf(d1, newDistance), d0);
+                    fnlv_f closer = fnlv_ltf(newDistance, d0);
+                    d0 = fnlv_blendf(d0, newDistance, closer);
+                    closest = fnlv_blendi(closest, hash, closer);
+
+                    zi = fnlv_addi(zi, vOne);
+                    zPrimed = fnlv_addi(zPrimed, vPrimeZ);
+                }
+                yi = fnlv_addi(yi, vOne);
+                yPrimed = fnlv_addi(yPrimed, vPrimeY);
+            }
+            xi = fnlv_addi(xi, vOne);
+            xPrimed = fnlv_addi(xPrimed, vPrimeX);
+        }
+
+        fnlv_storef(distance0 + n, d0);
+        fnlv_storef(distance1 + n, d1);
+        fnlv_storei(closestHash + n, closest);
+    }
+    return n;
+}
+
+// Turns distance0 (already in out), distance1 and the closest hash into the state's return value.
+static FNLV_TARGET void FNLV(_fnlCellularReturn)(fnl_state *state, float *out, const float *distance1, const int *closestHash, int count)
+{
+    if (state->cellular_distance_func == FNL_CELLULAR_DISTANCE_EUCLIDEAN && state->cellular_return_type >= FNL_CELLULAR_RETURN_VALUE_DISTANCE)
+    {
+        for (int i = 0; i < count; i++) out[i] = _fnlFastSqrt(out[i]);
+    }
+    const bool sqrtDistance1 = state->cellular_distance_func == FNL_CELLULAR_DISTANCE_EUCLIDEAN && state->cellular_return_type >= FNL_CELLULAR_RETURN_VALUE_DISTANCE2;
+
+    switch (state->cellular_return_type)
+    {
+    case FNL_CELLULAR_RETURN_VALUE_CELLVALUE:
+        for (int i = 0; i < count; i++) out[i] = closestHash[i] * (1 / 2147483648.0f);
+        break;
+    case FNL_CELLULAR_RETURN_VALUE_DISTANCE:
+        for (int i = 0; i < count; i++) out[i] = out[i] - 1;
+        break;
+    case FNL_CELLULAR_RETURN_VALUE_DISTANCE2:
+        if (sqrtDistance1)
+            for (int i = 0; i < count; i++) out[i] = _fnlFastSqrt(distance1[i]) - 1;
+        else
+            for (int i = 0; i < count; i++) out[i] = distance1[i] - 1;
+        break;
+    case FNL_CELLULAR_RETURN_VALUE_DISTANCE2ADD:
+        if (sqrtDistance1)
+            for (int i = 0; i < count; i++) out[i] = (_fnlFastSqrt(distance1[i]) + out[i]) * 0.5f - 1;
+        else
+            for (int i = 0; i < count; i++) out[i] = (distance1[i] + out[i]) * 0.5f - 1;
+        break;
+    case FNL_CELLULAR_RETURN_VALUE_DISTANCE2SUB:
+        if (sqrtDistance1)
+            for (int i = 0; i < count; i++) out[i] = _fnlFastSqrt(distance1[i]) - out[i] - 1;
+        else
+            for (int i = 0; i < count; i++) out[i] = distance1[i] - out[i] - 1;
+        break;
+    case FNL_CELLULAR_RETURN_VALUE_DISTANCE2MUL:
+        if (sqrtDistance1)
+            for (int i = 0; i < count; i++) out[i] = _fnlFastSqrt(distance1[i]) * out[i] * 0.5f - 1;
+        else
+            for (int i = 0; i < count; i++) out[i] = distance1[i] * out[i] * 0.5f - 1;
+        break;
+    case FNL_CELLULAR_RETURN_VALUE_DISTANCE2DIV:
+        if (sqrtDistance1)
+            for (int i = 0; i < count; i++) out[i] = out[i] / _fnlFastSqrt(distance1[i]) - 1;
+        else
+            for (int i = 0; i < count; i++) out[i] = out[i] / distance1[i] - 1;
+        break;
+    default:
+        for (int i = 0; i < count; i++) out[i] = 0;
+        break;
+    }
+}
+
+static FNLV_TARGET void FNLV(_fnlCellularSpan2D)(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, float *out, int count)
+{
+    const float jitter = 0.5f * state->cellular_jitter_mod;
+    float distance1[FNL_SPAN_BLOCK];
+    int closestHash[FNL_SPAN_BLOCK];
+
+    for (int done = 0; done < count; done += FNL_SPAN_BLOCK)
+    {
+        int n = count - done < FNL_SPAN_BLOCK ? count - done : FNL_SPAN_BLOCK;
+        int vectored;
+
+        switch (state->cellular_distance_func)
+        {
+        default:
+            vectored = FNLV(_fnlCellularNeighbours2D)(FNL_CELLULAR_DISTANCE_EUCLIDEAN, seed, jitter, x + done, y + done, out + done, distance1, closestHash, n);
+            break;
+        case FNL_CELLULAR_DISTANCE_MANHATTAN:
+            vectored = FNLV(_fnlCellularNeighbours2D)(FNL_CELLULAR_DISTANCE_MANHATTAN, seed, jitter, x + done, y + done, out + done, distance1, closestHash, n);
+            break;
+        case FNL_CELLULAR_DISTANCE_HYBRID:
+            vectored = FNLV(_fnlCellularNeighbours2D)(FNL_CELLULAR_DISTANCE_HYBRID, seed, jitter, x + done, y + done, out + done, distance1, closestHash, n);
+            break;
+        }
+
+        FNLV(_fnlCellularReturn)(state, out + done, distance1, closestHash, vectored);
+
+        for (int i = done + vectored; i < done + n; i++)
+            out[i] = _fnlSingleCellular2D(state, seed, x[i], y[i]);
+    }
+}
+
+static FNLV_TARGET void FNLV(_fnlCellularSpan3D)(fnl_state *state, int seed, const FNLfloat *x, const FNLfloat *y, const FNLfloat *z, float *out, int count)
+{
+    const float jitter = 0.39614353f * state->cellular_jitter_mod;
+    float distance1[FNL_SPAN_BLOCK];
+    int closestHash[FNL_SPAN_BLOCK];
+
+    for (int done = 0; done < count; done += FNL_SPAN_BLOCK)
+    {
+        int n = count - done < FNL_SPAN_BLOCK ? count - done : FNL_SPAN_BLOCK;
+        int vectored;
+
+        switch (state->cellular_distance_func)
+        {
+        default:
+            vectored = FNLV(_fnlCellularNeighbours3D)(FNL_CELLULAR_DISTANCE_EUCLIDEAN, seed, jitter, x + done, y + done, z + done, out + done, distance1, closestHash, n);
+            break;
+        case FNL_CELLULAR_DISTANCE_MANHATTAN:
+            vectored = FNLV(_fnlCellularNeighbours3D)(FNL_CELLULAR_DISTANCE_MANHATTAN, seed, jitter, x + done, y + done, z + done, out + done, distance1, closestHash, n);
+            break;
+        case FNL_CELLULAR_DISTANCE_HYBRID:
+            vectored = FNLV(_fnlCellularNeighbours3D)(FNL_CELLULAR_DISTANCE_HYBRID, seed, jitter, x + done, y + done, z + done, out + done, distance1, closestHash, n);
+            break;
+        }
+
+        FNLV(_fnlCellularReturn)(state, out + done, distance1, closestHash, vectored);
+
+        for (int i = done + vectored; i < done + n; i++)
+            out[i] = _fnlSingleCellular3D(state, seed, x[i], y[i], z[i]);
+    }
+}
+
+// Kernel table for this width, see _fnlSpanKernels in fastnoise.h
+
+static const _fnlSpanKernels FNLV(_fnlSpanKernels) = {
+    FNLV(_fnlSimplexSpan2D),
+    FNLV(_fnlOpenSimplex2Span3D),
+    FNLV(_fnlPerlinSpan2D),
+    FNLV(_fnlPerlinSpan3D),
+    FNLV(_fnlCellularSpan2D),
+    FNLV(_fnlCellularSpan3D),
+};
+
+#undef fnlv_f
+#undef fnlv_i
+#undef FNLV
+#undef FNLV_TARGET
+#undef fnlv_loadf
+#undef fnlv_storef
+#undef fnlv_storei
+#undef fnlv_setf
+#undef fnlv_seti
+#undef fnlv_addf
+#undef fnlv_subf
+#undef fnlv_mulf
+#undef fnlv_divf
+#undef fnlv_minf
+#undef fnlv_maxf
+#undef fnlv_xorf
+#undef fnlv_andf
+#undef fnlv_orf
+#undef fnlv_andnotf
+#undef fnlv_ltf
+#undef fnlv_lef
+#undef fnlv_gtf
+#undef fnlv_gef
+#undef fnlv_blendf
+#undef fnlv_addi
+#undef fnlv_subi
+#undef fnlv_muli
+#undef fnlv_xori
+#undef fnlv_andi
+#undef fnlv_ori
+#undef fnlv_srai
+#undef fnlv_slli
+#undef fnlv_blendi
+#undef fnlv_itof
+#undef fnlv_ftoi
+#undef fnlv_castitof
+#undef fnlv_castftoi
+#undef fnlv_gather
@@ -52,6 +52,20 @@ USAGE:
 
      void stbi_flip_vertically_on_write(int flag); // flag is non-zero to flip data vertically
 
+   PNGs too large to hold in memory can be streamed a band of rows at a time,
+   top to bottom, to a write function (flip_vertically_on_write is ignored):
+
+     int stbi_write_png_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int w, int h, int comp);
+     int stbi_write_png_16_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int w, int h, int comp);
+     int stbi_write_png_stream_rows(stbi_png_stream *s, const void *data, int rows, int stride_in_bytes);
+     int stbi_write_png_stream_end(stbi_png_stream *s);
+
+   The 16 bit variant takes big endian samples. HDR can be streamed the same way,
+   after a header of the full size:
+
+     int stbi_write_hdr_stream_begin(stbi_write_func *func, void *context, int w, int h);
+     int stbi_write_hdr_stream_rows(stbi_write_func *func, void *context, int w, int rows, int comp, const float *data);
+
    There are also five equivalent functions that use an arbitrary write function. You are
    expected to open/close your file-equivalent before and after calling these:
 
@@ -66,7 +80,7 @@ USAGE:
 
    You can configure it with these global variables:
       int stbi_write_tga_with_rle;             // defaults to true; set to 0 to disable RLE
-      int stbi_write_png_compression_level;    // defaults to 8; set to higher for more compression
+      int stbi_write_png_compression_level;    // defaults to 8; set to higher for more compression, 0 stores
       int stbi_write_force_png_filter;         // defaults to -1; set to 0..5 to force a filter mode
 
 
@@ -194,6 +208,34 @@ STBIWDEF int stbi_write_jpg_to_func(stbi_write_func *func, void *context, int x,
 
 STBIWDEF void stbi_flip_vertically_on_write(int flip_boolean);
 
+#ifndef STBIW_ZLIB_COMPRESS
+// Raw deflate of data[dict_len, dict_len+data_len), matches may reach back into the
+// dict_len bytes before it. Output ends on a byte boundary, a non-final segment with
+// an empty stored block, so segments compressed apart can be concatenated.
+STBIWDEF unsigned char *stbi_zlib_compress_segment(unsigned char *data, int dict_len, int data_len, int *out_len, int quality, int final);
+
+typedef struct
+{
+   stbi_write_func *func;
+   void *context;
+   int x, y, n, rows;      // n is bytes per pixel
+   unsigned char *prev;    // last row written, filters of the next band look up at it
+   unsigned char *window;  // last 32K of filtered data, primes matches of the next band
+   int window_len;
+   unsigned int s1, s2;    // adler32 of all filtered data so far
+} stbi_png_stream;
+
+STBIWDEF int stbi_write_png_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int w, int h, int comp);
+STBIWDEF int stbi_write_png_16_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int w, int h, int comp);
+STBIWDEF int stbi_write_png_stream_rows(stbi_png_stream *s, const void *data, int rows, int stride_in_bytes);
+STBIWDEF int stbi_write_png_stream_end(stbi_png_stream *s);
+#endif
+
+#ifndef STBI_WRITE_NO_STDIO
+STBIWDEF int stbi_write_hdr_stream_begin(stbi_write_func *func, void *context, int w, int h);
+STBIWDEF int stbi_write_hdr_stream_rows(stbi_write_func *func, void *context, int w, int rows, int comp, const float *data);
+#endif
+
 #endif//INCLUDE_STB_IMAGE_WRITE_H
 
 #ifdef STB_IMAGE_WRITE_IMPLEMENTATION
@@ -758,6 +800,21 @@ static void stbiw__write_hdr_scanline(stbi__write_context *s, int width, int nco
    }
 }
 
+static void stbiw__write_hdr_header(stbi__write_context *s, int x, int y)
+{
+   int len;
+   char buffer[128];
+   char header[] = "#?RADIANCE\n# Written by stb_image_write.h\nFORMAT=32-bit_rle_rgbe\n";
+   s->func(s->context, header, sizeof(header)-1);
+
+#ifdef __STDC_LIB_EXT1__
+   len = sprintf_s(buffer, sizeof(buffer), "EXPOSURE=          1.0000000000000\n\n-Y %d +X %d\n", y, x);
+#else
+   len = sprintf(buffer, "EXPOSURE=          1.0000000000000\n\n-Y %d +X %d\n", y, x);
+#endif
+   s->func(s->context, buffer, len);
+}
+
 static int stbi_write_hdr_core(stbi__write_context *s, int x, int y, int comp, float *data)
 {
    if (y <= 0 || x <= 0 || data == NULL)
@@ -765,17 +822,8 @@ static int stbi_write_hdr_core(stbi__write_context *s, int x, int y, int comp, f
    else {
       // Each component is stored separately. Allocate scratch space for full output scanline.
       unsigned char *scratch = (unsigned char *) STBIW_MALLOC(x*4);
-      int i, len;
-      char buffer[128];
-      char header[] = "#?RADIANCE\n# Written by stb_image_write.h\nFORMAT=32-bit_rle_rgbe\n";
-      s->func(s->context, header, sizeof(header)-1);
-
-#ifdef __STDC_LIB_EXT1__
-      len = sprintf_s(buffer, sizeof(buffer), "EXPOSURE=          1.0000000000000\n\n-Y %d +X %d\n", y, x);
-#else
-      len = sprintf(buffer, "EXPOSURE=          1.0000000000000\n\n-Y %d +X %d\n", y, x);
-#endif
-      s->func(s->context, buffer, len);
+      int i;
+      stbiw__write_hdr_header(s, x, y);
 
       for(i=0; i < y; i++)
          stbiw__write_hdr_scanline(s, x, comp, scratch, data + comp*x*(stbi__flip_vertically_on_write ? y-1-i : i));
@@ -801,6 +849,30 @@ STBIWDEF int stbi_write_hdr(char const *filename, int x, int y, int comp, const
    } else
       return 0;
 }
+
+STBIWDEF int stbi_write_hdr_stream_begin(stbi_write_func *func, void *context, int x, int y)
+{
+   stbi__write_context s = { 0 };
+   if (y <= 0 || x <= 0)
+      return 0;
+   stbi__start_write_callbacks(&s, func, context);
+   stbiw__write_hdr_header(&s, x, y);
+   return 1;
+}
+
+// Rows follow the header top to bottom, flip_vertically_on_write is ignored
+STBIWDEF int stbi_write_hdr_stream_rows(stbi_write_func *func, void *context, int x, int rows, int comp, const float *data)
+{
+   stbi__write_context s = { 0 };
+   unsigned char *scratch = (unsigned char *) STBIW_MALLOC(x*4);
+   int i;
+   if (!scratch || data == NULL) { STBIW_FREE(scratch); return 0; }
+   stbi__start_write_callbacks(&s, func, context);
+   for (i=0; i < rows; i++)
+      stbiw__write_hdr_scanline(&s, x, comp, scratch, (float *) data + comp*x*i);
+   STBIW_FREE(scratch);
+   return 1;
+}
 #endif // STBI_WRITE_NO_STDIO
 
 
@@ -892,34 +964,68 @@ static unsigned int stbiw__zhash(unsigned char *data)
 
 #endif // STBIW_ZLIB_COMPRESS
 
-STBIWDEF unsigned char * stbi_zlib_compress(unsigned char *data, int data_len, int *out_len, int quality)
+#ifndef STBIW_ZLIB_COMPRESS
+// Appends data as stored blocks, the last one final if final is set
+static unsigned char *stbiw__zlib_store(unsigned char *out, unsigned char *data, int data_len, int final)
+{
+   int j = 0;
+   do {
+      int blocklen = data_len - j;
+      if (blocklen > 32767) blocklen = 32767;
+      stbiw__sbpush(out, final && data_len - j == blocklen); // BFINAL = ?, BTYPE = 0 -- no compression
+      stbiw__sbpush(out, STBIW_UCHAR(blocklen)); // LEN
+      stbiw__sbpush(out, STBIW_UCHAR(blocklen >> 8));
+      stbiw__sbpush(out, STBIW_UCHAR(~blocklen)); // NLEN
+      stbiw__sbpush(out, STBIW_UCHAR(~blocklen >> 8));
+      stbiw__sbmaybegrow(out, blocklen);
+      memcpy(out+stbiw__sbn(out), data+j, blocklen);
+      stbiw__sbn(out) += blocklen;
+      j += blocklen;
+   } while (j < data_len);
+   return out;
+}
+
+// Appends a deflate segment of data[dict_len, dict_len+data_len) to out, see stbi_zlib_compress_segment
+static unsigned char *stbiw__zlib_deflate(unsigned char *out, unsigned char *data, int dict_len, int data_len, int quality, int final)
 {
-#ifdef STBIW_ZLIB_COMPRESS
-   // user provided a zlib compress implementation, use that
-   return STBIW_ZLIB_COMPRESS(data, data_len, out_len, quality);
-#else // use builtin
    static unsigned short lengthc[] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258, 259 };
    static unsigned char  lengtheb[]= { 0,0,0,0,0,0,0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,  4,  5,  5,  5,  5,  0 };
    static unsigned short distc[]   = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577, 32768 };
    static unsigned char  disteb[]  = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
    unsigned int bitbuf=0;
    int i,j, bitcount=0;
-   unsigned char *out = NULL;
+   int start = stbiw__sbcount(out), end = dict_len + data_len;
+   unsigned char *src = data + dict_len;
    unsigned char ***hash_table = (unsigned char***) STBIW_MALLOC(stbiw__ZHASH * sizeof(unsigned char**));
-   if (hash_table == NULL)
+   if (hash_table == NULL) {
+      (void) stbiw__sbfree(out);
       return NULL;
+   }
+   if (quality <= 0) {
+      // level 0 skips matching and stores
+      STBIW_FREE(hash_table);
+      return stbiw__zlib_store(out, src, data_len, final);
+   }
    if (quality < 5) quality = 5;
 
-   stbiw__sbpush(out, 0x78);   // DEFLATE 32K window
-   stbiw__sbpush(out, 0x5e);   // FLEVEL = 1
-   stbiw__zlib_add(1,1);  // BFINAL = 1
+   stbiw__zlib_add(final ? 1 : 0,1);  // BFINAL
    stbiw__zlib_add(1,2);  // BTYPE = 1 -- fixed huffman
 
    for (i=0; i < stbiw__ZHASH; ++i)
       hash_table[i] = NULL;
 
-   i=0;
-   while (i < data_len-3) {
+   // the dictionary only feeds the hash table, within the window of the first byte
+   for (i = dict_len > 32768 ? dict_len - 32768 : 0; i < dict_len && i < end-3; ++i) {
+      int h = stbiw__zhash(data+i)&(stbiw__ZHASH-1);
+      if (hash_table[h] && stbiw__sbn(hash_table[h]) == 2*quality) {
+         STBIW_MEMMOVE(hash_table[h], hash_table[h]+quality, sizeof(hash_table[h][0])*quality);
+         stbiw__sbn(hash_table[h]) = quality;
+      }
+      stbiw__sbpush(hash_table[h],data+i);
+   }
+
+   i=dict_len;
+   while (i < end-3) {
       // hash next 3 bytes of data to be compressed
       int h = stbiw__zhash(data+i)&(stbiw__ZHASH-1), best=3;
       unsigned char *bestloc = 0;
@@ -927,7 +1033,7 @@ STBIWDEF unsigned char * stbi_zlib_compress(unsigned char *data, int data_len, i
       int n = stbiw__sbcount(hlist);
       for (j=0; j < n; ++j) {
          if (hlist[j]-data > i-32768) { // if entry lies within window
-            int d = stbiw__zlib_countm(hlist[j], data+i, data_len-i);
+            int d = stbiw__zlib_countm(hlist[j], data+i, end-i);
             if (d >= best) { best=d; bestloc=hlist[j]; }
          }
       }
@@ -945,7 +1051,7 @@ STBIWDEF unsigned char * stbi_zlib_compress(unsigned char *data, int data_len, i
          n = stbiw__sbcount(hlist);
          for (j=0; j < n; ++j) {
             if (hlist[j]-data > i-32767) {
-               int e = stbiw__zlib_countm(hlist[j], data+i+1, data_len-i-1);
+               int e = stbiw__zlib_countm(hlist[j], data+i+1, end-i-1);
                if (e > best) { // if next match is better, bail on current match
                   bestloc = NULL;
                   break;
@@ -970,50 +1076,78 @@ STBIWDEF unsigned char * stbi_zlib_compress(unsigned char *data, int data_len, i
       }
    }
    // write out final bytes
-   for (;i < data_len; ++i)
+   for (;i < end; ++i)
       stbiw__zlib_huffb(data[i]);
    stbiw__zlib_huff(256); // end of block
+   if (!final) {
+      // empty stored block, byte aligns the segment
+      stbiw__zlib_add(0,1);
+      stbiw__zlib_add(0,2);
+   }
    // pad with 0 bits to byte boundary
    while (bitcount)
       stbiw__zlib_add(0,1);
+   if (!final) {
+      stbiw__sbpush(out, 0x00);
+      stbiw__sbpush(out, 0x00);
+      stbiw__sbpush(out, 0xff);
+      stbiw__sbpush(out, 0xff);
+   }
 
    for (i=0; i < stbiw__ZHASH; ++i)
       (void) stbiw__sbfree(hash_table[i]);
    STBIW_FREE(hash_table);
 
    // store uncompressed instead if compression was worse
-   if (stbiw__sbn(out) > data_len + 2 + ((data_len+32766)/32767)*5) {
-      stbiw__sbn(out) = 2;  // truncate to DEFLATE 32K window and FLEVEL = 1
-      for (j = 0; j < data_len;) {
-         int blocklen = data_len - j;
-         if (blocklen > 32767) blocklen = 32767;
-         stbiw__sbpush(out, data_len - j == blocklen); // BFINAL = ?, BTYPE = 0 -- no compression
-         stbiw__sbpush(out, STBIW_UCHAR(blocklen)); // LEN
-         stbiw__sbpush(out, STBIW_UCHAR(blocklen >> 8));
-         stbiw__sbpush(out, STBIW_UCHAR(~blocklen)); // NLEN
-         stbiw__sbpush(out, STBIW_UCHAR(~blocklen >> 8));
-         memcpy(out+stbiw__sbn(out), data+j, blocklen);
-         stbiw__sbn(out) += blocklen;
-         j += blocklen;
-      }
+   if (stbiw__sbn(out) - start > data_len + ((data_len+32766)/32767)*5) {
+      stbiw__sbn(out) = start;
+      out = stbiw__zlib_store(out, src, data_len, final);
    }
+   return out;
+}
 
-   {
-      // compute adler32 on input
-      unsigned int s1=1, s2=0;
-      int blocklen = (int) (data_len % 5552);
-      j=0;
-      while (j < data_len) {
-         for (i=0; i < blocklen; ++i) { s1 += data[j+i]; s2 += s1; }
-         s1 %= 65521; s2 %= 65521;
-         j += blocklen;
-         blocklen = 5552;
-      }
-      stbiw__sbpush(out, STBIW_UCHAR(s2 >> 8));
-      stbiw__sbpush(out, STBIW_UCHAR(s2));
-      stbiw__sbpush(out, STBIW_UCHAR(s1 >> 8));
-      stbiw__sbpush(out, STBIW_UCHAR(s1));
+static void stbiw__adler32(unsigned int *s1, unsigned int *s2, unsigned char *data, int data_len)
+{
+   int i, j=0, blocklen = (int) (data_len % 5552);
+   while (j < data_len) {
+      for (i=0; i < blocklen; ++i) { *s1 += data[j+i]; *s2 += *s1; }
+      *s1 %= 65521; *s2 %= 65521;
+      j += blocklen;
+      blocklen = 5552;
    }
+}
+
+STBIWDEF unsigned char *stbi_zlib_compress_segment(unsigned char *data, int dict_len, int data_len, int *out_len, int quality, int final)
+{
+   unsigned char *out = stbiw__zlib_deflate(NULL, data, dict_len, data_len, quality, final);
+   if (!out) return NULL;
+   *out_len = stbiw__sbn(out);
+   // make returned pointer freeable
+   STBIW_MEMMOVE(stbiw__sbraw(out), out, *out_len);
+   return (unsigned char *) stbiw__sbraw(out);
+}
+#endif // STBIW_ZLIB_COMPRESS
+
+STBIWDEF unsigned char * stbi_zlib_compress(unsigned char *data, int data_len, int *out_len, int quality)
+{
+#ifdef STBIW_ZLIB_COMPRESS
+   // user provided a zlib compress implementation, use that
+   return STBIW_ZLIB_COMPRESS(data, data_len, out_len, quality);
+#else // use builtin
+   unsigned int s1=1, s2=0;
+   unsigned char *out = NULL;
+
+   stbiw__sbpush(out, 0x78);   // DEFLATE 32K window
+   stbiw__sbpush(out, 0x5e);   // FLEVEL = 1
+   out = stbiw__zlib_deflate(out, data, 0, data_len, quality, 1);
+   if (!out) return NULL;
+
+   // compute adler32 on input
+   stbiw__adler32(&s1, &s2, data, data_len);
+   stbiw__sbpush(out, STBIW_UCHAR(s2 >> 8));
+   stbiw__sbpush(out, STBIW_UCHAR(s2));
+   stbiw__sbpush(out, STBIW_UCHAR(s1 >> 8));
+   stbiw__sbpush(out, STBIW_UCHAR(s1));
    *out_len = stbiw__sbn(out);
    // make returned pointer freeable
    STBIW_MEMMOVE(stbiw__sbraw(out), out, *out_len);
@@ -1089,15 +1223,14 @@ static unsigned char stbiw__paeth(int a, int b, int c)
 }
 
 // @OPTIMIZE: provide an option that always forces left-predict or paeth predict
-static void stbiw__encode_png_line(unsigned char *pixels, int stride_bytes, int width, int height, int y, int n, int filter_type, signed char *line_buffer)
+// up is the row above z, NULL on the first row
+static void stbiw__encode_png_line(const unsigned char *z, const unsigned char *up, int width, int n, int filter_type, signed char *line_buffer)
 {
    static int mapping[] = { 0,1,2,3,4 };
    static int firstmap[] = { 0,1,0,5,6 };
-   int *mymap = (y != 0) ? mapping : firstmap;
+   int *mymap = up ? mapping : firstmap;
    int i;
    int type = mymap[filter_type];
-   unsigned char *z = pixels + stride_bytes * (stbi__flip_vertically_on_write ? height-1-y : y);
-   int signed_stride = stbi__flip_vertically_on_write ? -stride_bytes : stride_bytes;
 
    if (type==0) {
       memcpy(line_buffer, z, width*n);
@@ -1108,23 +1241,53 @@ static void stbiw__encode_png_line(unsigned char *pixels, int stride_bytes, int
    for (i = 0; i < n; ++i) {
       switch (type) {
          case 1: line_buffer[i] = z[i]; break;
-         case 2: line_buffer[i] = z[i] - z[i-signed_stride]; break;
-         case 3: line_buffer[i] = z[i] - (z[i-signed_stride]>>1); break;
-         case 4: line_buffer[i] = (signed char) (z[i] - stbiw__paeth(0,z[i-signed_stride],0)); break;
+         case 2: line_buffer[i] = z[i] - up[i]; break;
+         case 3: line_buffer[i] = z[i] - (up[i]>>1); break;
+         case 4: line_buffer[i] = (signed char) (z[i] - stbiw__paeth(0,up[i],0)); break;
          case 5: line_buffer[i] = z[i]; break;
          case 6: line_buffer[i] = z[i]; break;
       }
    }
    switch (type) {
       case 1: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - z[i-n]; break;
-      case 2: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - z[i-signed_stride]; break;
-      case 3: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - ((z[i-n] + z[i-signed_stride])>>1); break;
-      case 4: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - stbiw__paeth(z[i-n], z[i-signed_stride], z[i-signed_stride-n]); break;
+      case 2: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - up[i]; break;
+      case 3: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - ((z[i-n] + up[i])>>1); break;
+      case 4: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - stbiw__paeth(z[i-n], up[i], up[i-n]); break;
       case 5: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - (z[i-n]>>1); break;
       case 6: for (i=n; i < width*n; ++i) line_buffer[i] = z[i] - stbiw__paeth(z[i-n], 0,0); break;
    }
 }
 
+// Filters a row into line_buffer with force_filter, or the filter estimated best if it is -1
+static int stbiw__filter_png_line(const unsigned char *z, const unsigned char *up, int width, int n, int force_filter, signed char *line_buffer)
+{
+   int filter_type;
+   if (force_filter > -1) {
+      filter_type = force_filter;
+      stbiw__encode_png_line(z, up, width, n, force_filter, line_buffer);
+   } else { // Estimate the best filter by running through all of them:
+      int best_filter = 0, best_filter_val = 0x7fffffff, est, i;
+      for (filter_type = 0; filter_type < 5; filter_type++) {
+         stbiw__encode_png_line(z, up, width, n, filter_type, line_buffer);
+
+         // Estimate the entropy of the line using this filter; the less, the better.
+         est = 0;
+         for (i = 0; i < width*n; ++i) {
+            est += abs((signed char) line_buffer[i]);
+         }
+         if (est < best_filter_val) {
+            best_filter_val = est;
+            best_filter = filter_type;
+         }
+      }
+      if (filter_type != best_filter) {  // If the last iteration already got us the best filter, don't redo it
+         stbiw__encode_png_line(z, up, width, n, best_filter, line_buffer);
+         filter_type = best_filter;
+      }
+   }
+   return filter_type;
+}
+
 STBIWDEF unsigned char *stbi_write_png_to_mem(const unsigned char *pixels, int stride_bytes, int x, int y, int n, int *out_len)
 {
    int force_filter = stbi_write_force_png_filter;
@@ -1144,30 +1307,9 @@ STBIWDEF unsigned char *stbi_write_png_to_mem(const unsigned char *pixels, int s
    filt = (unsigned char *) STBIW_MALLOC((x*n+1) * y); if (!filt) return 0;
    line_buffer = (signed char *) STBIW_MALLOC(x * n); if (!line_buffer) { STBIW_FREE(filt); return 0; }
    for (j=0; j < y; ++j) {
-      int filter_type;
-      if (force_filter > -1) {
-         filter_type = force_filter;
-         stbiw__encode_png_line((unsigned char*)(pixels), stride_bytes, x, y, j, n, force_filter, line_buffer);
-      } else { // Estimate the best filter by running through all of them:
-         int best_filter = 0, best_filter_val = 0x7fffffff, est, i;
-         for (filter_type = 0; filter_type < 5; filter_type++) {
-            stbiw__encode_png_line((unsigned char*)(pixels), stride_bytes, x, y, j, n, filter_type, line_buffer);
-
-            // Estimate the entropy of the line using this filter; the less, the better.
-            est = 0;
-            for (i = 0; i < x*n; ++i) {
-               est += abs((signed char) line_buffer[i]);
-            }
-            if (est < best_filter_val) {
-               best_filter_val = est;
-               best_filter = filter_type;
-            }
-         }
-         if (filter_type != best_filter) {  // If the last iteration already got us the best filter, don't redo it
-            stbiw__encode_png_line((unsigned char*)(pixels), stride_bytes, x, y, j, n, best_filter, line_buffer);
-            filter_type = best_filter;
-         }
-      }
+      int signed_stride = stbi__flip_vertically_on_write ? -stride_bytes : stride_bytes;
+      const unsigned char *z = pixels + stride_bytes * (stbi__flip_vertically_on_write ? y-1-j : j);
+      int filter_type = stbiw__filter_png_line(z, j ? z - signed_stride : NULL, x, n, force_filter, line_buffer);
       // when we get here, filter_type contains the filter type, and line_buffer contains the data
       filt[j*(x*n+1)] = (unsigned char) filter_type;
       STBIW_MEMMOVE(filt+j*(x*n+1)+1, line_buffer, x*n);
@@ -1238,6 +1380,165 @@ STBIWDEF int stbi_write_png_to_func(stbi_write_func *func, void *context, int x,
    return 1;
 }
 
+#ifndef STBIW_ZLIB_COMPRESS
+// Writes a chunk of type tag holding the two parts a and b, either may be empty
+static int stbiw__png_stream_chunk(stbi_png_stream *s, const char *tag, const unsigned char *a, int alen, const unsigned char *b, int blen)
+{
+   unsigned char *chunk = (unsigned char *) STBIW_MALLOC(12 + alen + blen), *o = chunk;
+   if (!chunk) return 0;
+   stbiw__wp32(o, alen + blen);
+   stbiw__wptag(o, tag);
+   if (alen) STBIW_MEMMOVE(o, a, alen);
+   if (blen) STBIW_MEMMOVE(o + alen, b, blen);
+   o += alen + blen;
+   stbiw__wpcrc(&o, alen + blen);
+   s->func(s->context, chunk, 12 + alen + blen);
+   STBIW_FREE(chunk);
+   return 1;
+}
+
+static int stbiw__png_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int x, int y, int comp, int depth)
+{
+   int ctype[5] = { -1, 0, 4, 2, 6 };
+   unsigned char sig[8] = { 137,80,78,71,13,10,26,10 };
+   unsigned char ihdr[13], *o = ihdr;
+
+   memset(s, 0, sizeof(*s));
+   s->func = func;
+   s->context = context;
+   s->x = x;
+   s->y = y;
+   s->n = comp * depth / 8;
+   s->s1 = 1;
+   s->prev = (unsigned char *) STBIW_MALLOC(x * s->n);
+   s->window = (unsigned char *) STBIW_MALLOC(32768);
+   if (!s->prev || !s->window) {
+      stbi_write_png_stream_end(s);
+      return 0;
+   }
+
+   stbiw__wp32(o, x);
+   stbiw__wp32(o, y);
+   *o++ = STBIW_UCHAR(depth);
+   *o++ = STBIW_UCHAR(ctype[comp]);
+   *o++ = 0;
+   *o++ = 0;
+   *o++ = 0;
+   func(context, sig, 8);
+   return stbiw__png_stream_chunk(s, "IHDR", ihdr, 13, NULL, 0);
+}
+
+STBIWDEF int stbi_write_png_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int x, int y, int comp)
+{
+   return stbiw__png_stream_begin(s, func, context, x, y, comp, 8);
+}
+
+STBIWDEF int stbi_write_png_16_stream_begin(stbi_png_stream *s, stbi_write_func *func, void *context, int x, int y, int comp)
+{
+   return stbiw__png_stream_begin(s, func, context, x, y, comp, 16);
+}
+
+#ifndef STBIW_PNG_SEGMENT
+#define STBIW_PNG_SEGMENT 131072
+#endif
+
+// Filters and deflates the next rows, the band reaching the last row closes the stream.
+// Rows are filtered in parallel and the band is deflated in STBIW_PNG_SEGMENT byte
+// segments at once when built with OpenMP, each primed with the 32K before it.
+// Every segment goes out as its own IDAT chunk.
+STBIWDEF int stbi_write_png_stream_rows(stbi_png_stream *s, const void *data, int rows, int stride_bytes)
+{
+   const unsigned char *pixels = (const unsigned char *) data;
+   int n = s->n, line = s->x * n + 1, len = line * rows, final, ok = 1, j;
+   int force_filter = stbi_write_force_png_filter < 5 ? stbi_write_force_png_filter : -1;
+   int segments = (len + STBIW_PNG_SEGMENT - 1) / STBIW_PNG_SEGMENT;
+   unsigned char *filt, **zlib, *band, head[2] = { 0x78, 0x5e }, tail[4];
+   int *zlen;
+
+   if (rows <= 0 || s->rows + rows > s->y) return 0;
+   if (stride_bytes == 0) stride_bytes = s->x * n;
+   final = s->rows + rows == s->y;
+
+   // filtered rows go right after the window, matches may reach back into it
+   filt = (unsigned char *) STBIW_MALLOC(s->window_len + len);
+   zlib = (unsigned char **) STBIW_MALLOC(segments * (sizeof(*zlib) + sizeof(*zlen)));
+   if (!filt || !zlib) { STBIW_FREE(filt); STBIW_FREE(zlib); return 0; }
+   zlen = (int *) (zlib + segments);
+   STBIW_MEMMOVE(filt, s->window, s->window_len);
+   band = filt + s->window_len;
+
+#ifdef _OPENMP
+   #pragma omp parallel for
+#endif
+   for (j=0; j < rows; ++j) {
+      const unsigned char *z = pixels + stride_bytes * j;
+      const unsigned char *up = j ? z - stride_bytes : s->rows ? s->prev : NULL;
+      unsigned char *f = band + j * line;
+      f[0] = (unsigned char) stbiw__filter_png_line(z, up, s->x, n, force_filter, (signed char *) f + 1);
+   }
+   STBIW_MEMMOVE(s->prev, pixels + stride_bytes * (rows-1), s->x * n);
+
+#ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic)
+#endif
+   for (j=0; j < segments; ++j) {
+      int at = j * STBIW_PNG_SEGMENT, dict = s->window_len + at;
+      int seglen = len - at < STBIW_PNG_SEGMENT ? len - at : STBIW_PNG_SEGMENT;
+      if (dict > 32768) dict = 32768;
+      zlib[j] = stbi_zlib_compress_segment(band + at - dict, dict, seglen, &zlen[j]
+            , stbi_write_png_compression_level, final && j == segments-1);
+   }
+   stbiw__adler32(&s->s1, &s->s2, band, len);
+
+   {
+      int keep = s->window_len + len;
+      if (keep > 32768) keep = 32768;
+      STBIW_MEMMOVE(s->window, band + len - keep, keep);
+      s->window_len = keep;
+   }
+   STBIW_FREE(filt);
+
+   for (j=0; j < segments; ++j) ok &= zlib[j] != NULL;
+   if (ok && final) {
+      unsigned char *o = tail, *last = zlib[segments-1];
+      stbiw__wpng4(o, s->s2 >> 8, s->s2, s->s1 >> 8, s->s1);
+      last = (unsigned char *) STBIW_REALLOC_SIZED(last, zlen[segments-1], zlen[segments-1] + 4);
+      if (last) {
+         STBIW_MEMMOVE(last + zlen[segments-1], tail, 4);
+         zlib[segments-1] = last;
+         zlen[segments-1] += 4;
+      }
+      ok = last != NULL;
+   }
+   for (j=0; j < segments; ++j) {
+      if (ok) ok = stbiw__png_stream_chunk(s, "IDAT", head, s->rows || j ? 0 : 2, zlib[j], zlen[j]);
+      STBIW_FREE(zlib[j]);
+   }
+   STBIW_FREE(zlib);
+   s->rows += rows;
+   return ok;
+}
+
+// Writes IEND once every row went in, frees the stream either way
+STBIWDEF int stbi_write_png_stream_end(stbi_png_stream *s)
+{
+   int ok = s->prev && s->rows == s->y;
+   if (ok && s->y == 0) {
+      // no rows call ever came, an empty image still needs its one (empty) zlib stream
+      int zlen;
+      unsigned char *zlib = stbi_zlib_compress(s->window, 0, &zlen, stbi_write_png_compression_level);
+      ok = zlib && stbiw__png_stream_chunk(s, "IDAT", zlib, zlen, NULL, 0);
+      STBIW_FREE(zlib);
+   }
+   ok = ok && stbiw__png_stream_chunk(s, "IEND", NULL, 0, NULL, 0);
+   STBIW_FREE(s->prev);
+   STBIW_FREE(s->window);
+   s->prev = NULL;
+   s->window = NULL;
+   return ok;
+}
+#endif // STBIW_ZLIB_COMPRESS
+
 
 /* ***************************************************************************
  *
@@ -2,6 +2,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <z_/types/base.h>
 #include <z_/types/record.h>
@@ -17,8 +28,6 @@
 #include <z_/imp/termio.h>
 #include <z_/imp/time.h>
 
-#include <zsf/map/ch.h>
-
 #define FNL_IMPL
 #include "ext/fastnoise.h"
 
@@ -72,6 +81,18 @@
     HELP_TXT_NOISE\
     "\n"\
     "-r     --write [S]         Create an image file (.png)\n"\
+    "-L     --level [N]         PNG compression effort, 8 by default, 0 stores\n"\
+    "-m     --mips [N]          Also write [N] halved levels as NAME.1.png, NAME.2.png...\n"\
+    "-T     --tiles [DIR]       Write DIR/z/x/y.png tiles of a world -w cells across\n"\
+    "-Z     --zoom [N]          Deepest tile zoom level, 0 by default\n"\
+    "--batch [FILE]             Render every line of FILE as its own options\n"\
+    "-j     --jobs [N]          Batch jobs run at once, sharing the threads\n"\
+    "-f     --format [S]        Written format\n"\
+    "           | rgb           Background Colors, PNG\n"\
+    "           | gray16        Noise as 16 bit Grayscale PNG\n"\
+    "           | hdr           Noise as Radiance HDR\n"\
+    "           | f32           Noise as raw float32, memory mapped\n"\
+    "           | idx           Palette and Charlist indices, memory mapped\n"\
     "\n"\
     "--cmd \"[CMD]\"\n"\
     "--cmdfile [FILE]           Read Color and Char format from file\n"\
@@ -82,11 +103,25 @@
     "-d     --draw [S]          Set in Draw Mode/Method\n"\
     "           | char          Only Characters, Colorless\n"\
     "           | obg           Only Background Color\n"\
-    "-e                         Start In Explorer Mode\n"
-
-
-typedef z__RecordX((z__u32, ch), (z__u32, clr_fg, clr_bg)) MapPlot;
-typedef zsf_MapCh(MapPlot) Map;
+    "           | half          Half Blocks, 1x2 samples per cell\n"\
+    "           | quad          Quadrant Blocks, 2x2 samples per cell\n"\
+    "           | bg256         Background Color, xterm 256 colors\n"\
+    "           | bg16          Background Color, ANSI 16 colors\n"\
+    "-e                         Start In Explorer Mode\n"\
+    "-b     --bench [N]         Time [N] map generations\n"\
+    "-F     --fps [N]           Explorer target frames per second\n"\
+    "-C     --cache [MB]        Explorer tile cache budget, 64 by default\n"
+
+
+/**
+ * Charlist and palette index of every cell, one plane each, row major.
+ * A plane stores u8 indices while its list fits 256 entries, u16 (or u32) beyond.
+ */
+typedef struct Map {
+    void *ch, *clr;
+    z__Vint2 size;
+    z__u8 ch_bytes, clr_bytes;
+} Map;
 
 typedef z__Vector(z__u8, r, g, b) ColorRGB;
 typedef z__Arr(ColorRGB) ColorRGBArr;
@@ -99,6 +134,20 @@ struct Image {
     z__i32 channel_count;
 };
 
+/**
+ * Raw noise values, one float per cell, row major.
+ * Kept apart from the Map so palette and draw changes only need a quantize pass.
+ */
+typedef struct Field {
+    float *data;
+    z__Vint2 size;
+} Field;
+
+/* Region of a Field or Map in cells */
+typedef struct MapRect {
+    z__u32 x, y, w, h;
+} MapRect;
+
 typedef struct OFormat {
     struct {
         ColorRGB *fg;
@@ -113,7 +162,8 @@ typedef struct OFormat {
 } OFormat;
 
 typedef void (Drawfn)(Map *map, OFormat *oft);
-typedef void (GenMapFn)(Map *map, OFormat *oft, fnl_state *noise, z__Vector3 start);
+typedef enum ExportFormat { ExportRGB, ExportGray16, ExportHDR, ExportF32, ExportIndex } ExportFormat;
+typedef void (GenMapFn)(Field *field, fnl_state *noise, z__Vector3 start, MapRect rect);
 typedef ColorRGB (ColorMathFn)(ColorRGB, ColorRGB);
 
 struct ne_state {
@@ -121,6 +171,16 @@ struct ne_state {
     z__Vector3 start;
     fnl_state noise;
     z__u32 color;
+    z__u32 bench;
+    z__u32 fps;
+    z__u32 cache;
+    z__u32 png_level;
+    z__u32 mips;
+    z__u32 zoom;
+    char const *tiles_dir;
+    z__u32 jobs;
+    char const *batch_file;
+    ExportFormat format;
     char const *write_to_file_name;
     z__u32 startx, starty;
     Drawfn *draw;
@@ -140,6 +200,29 @@ void die(const char *msg)
     exit(1);
 }
 
+/* Monotonic time in milliseconds */
+double time_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+struct timespec time_ms_to_timespec(double ms)
+{
+    return (struct timespec){
+        .tv_sec = ms / 1e3,
+        .tv_nsec = (ms - (z__u64)(ms / 1e3) * 1e3) * 1e6,
+    };
+}
+
+/* Sleep until time_now_ms() reaches deadline */
+void time_sleep_until_ms(double deadline)
+{
+    struct timespec ts = time_ms_to_timespec(deadline);
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
 OFormat oft_new(const char *charl, z__size len)
 {
     enum {ColorLen = 16, CharLen = 16};
@@ -434,227 +517,2107 @@ Image Image_clone(Image *src)
 
 void Image_write_png(char const * path, Image *img)
 {
-    stbi_write_png(path, img->size.x, img->size.y, img->channel_count, img->data, img->size.x * img->channel_count);
+    if(!stbi_write_png(path, img->size.x, img->size.y, img->channel_count, img->data, img->size.x * img->channel_count))
+        die("Image Not Written");
+}
+
+Map Map_new(z__Vint2 size)
+{
+    return (Map){
+        .size = size,
+        .ch_bytes = 1,
+        .clr_bytes = 1,
+        .ch = z__CALLOC(size.x * size.y, 1),
+        .clr = z__CALLOC(size.x * size.y, 1),
+    };
+}
+
+void Map_delete(Map *map)
+{
+    z__FREE(map->ch);
+    z__FREE(map->clr);
+    memset(map, 0, sizeof(*map));
+}
+
+static inline z__u8 Map_index_bytes(z__size len)
+{
+    return len <= 0x100? 1: len <= 0x10000? 2: 4;
+}
+
+/* Widen or narrow the index planes to fit the current charlist and palette */
+void Map_fit(Map *map, OFormat const *oft)
+{
+    z__size cells = map->size.x * map->size.y;
+    z__u8 ch_bytes = Map_index_bytes(oft->ch_lenUsed);
+    z__u8 clr_bytes = Map_index_bytes(oft->color_lenUsed);
+
+    if(ch_bytes != map->ch_bytes) {
+        z__FREE(map->ch);
+        map->ch = z__MALLOC(cells * ch_bytes);
+        map->ch_bytes = ch_bytes;
+    }
+    if(clr_bytes != map->clr_bytes) {
+        z__FREE(map->clr);
+        map->clr = z__MALLOC(cells * clr_bytes);
+        map->clr_bytes = clr_bytes;
+    }
+}
+
+static inline z__u32 Map_index_get(void const *plane, z__u8 bytes, z__size i)
+{
+    switch(bytes) {
+        case 1: return ((z__u8 const *)plane)[i];
+        case 2: return ((z__u16 const *)plane)[i];
+        default: return ((z__u32 const *)plane)[i];
+    }
+}
+
+static inline void Map_index_set(void *plane, z__u8 bytes, z__size at, z__u32 const *idx, z__size count)
+{
+    switch(bytes) {
+        break; case 1: {
+            z__u8 *p = (z__u8 *)plane + at;
+            for (z__size i = 0; i < count; i++) p[i] = idx[i];
+        }
+        break; case 2: {
+            z__u16 *p = (z__u16 *)plane + at;
+            for (z__size i = 0; i < count; i++) p[i] = idx[i];
+        }
+        break; default:
+            memcpy((z__u32 *)plane + at, idx, count * sizeof(*idx));
+    }
+}
+
+#define Map_clr(map, i) Map_index_get((map)->clr, (map)->clr_bytes, i)
+#define Map_ch(map, i) Map_index_get((map)->ch, (map)->ch_bytes, i)
+
+/* Copy indices of src into dst of the same size, matching its plane widths */
+void Map_copy(Map *dst, Map const *src)
+{
+    z__size cells = src->size.x * src->size.y;
+    if(dst->ch_bytes != src->ch_bytes) {
+        z__FREE(dst->ch);
+        dst->ch = z__MALLOC(cells * src->ch_bytes);
+        dst->ch_bytes = src->ch_bytes;
+    }
+    if(dst->clr_bytes != src->clr_bytes) {
+        z__FREE(dst->clr);
+        dst->clr = z__MALLOC(cells * src->clr_bytes);
+        dst->clr_bytes = src->clr_bytes;
+    }
+    memcpy(dst->ch, src->ch, cells * src->ch_bytes);
+    memcpy(dst->clr, src->clr, cells * src->clr_bytes);
+}
+
+z__size Map_get_size(Map const *map)
+{
+    return (z__size)map->size.x * map->size.y * (map->ch_bytes + map->clr_bytes);
 }
 
 Image Image_newFrom_map(Map *map, OFormat *oft)
 {
     Image img = Image_new((z__Vint2){.x = map->size.x, .y = map->size.y}, 3);
 
-    z__u8 *i = img.data,
-          *endi = i + (img.size.x * img.size.y * img.channel_count);
+    z__u8 *i = img.data;
+    z__size cells = map->size.x * map->size.y;
+
+    for (z__size p = 0; p < cells; p++) {
+        ColorRGB c = oft->color.bg[Map_clr(map, p)];
+        i[0] = c.r;
+        i[1] = c.g;
+        i[2] = c.b;
+        i += 3;
+    }
+
+    return img;
+}
+
+/**
+ * Frame Buffer
+ * A whole frame is built here and handed to the terminal with one write(2).
+ * The buffer is kept between frames and only ever grows.
+ */
+typedef struct FrameBuf {
+    char *data;
+    z__size len, cap;
+} FrameBuf;
+
+static FrameBuf frame;
+
+void fb_reserve(FrameBuf *fb, z__size more)
+{
+    if(fb->len + more <= fb->cap) return;
+    fb->cap = (fb->len + more) * 2;
+    fb->data = z__REALLOC(fb->data, fb->cap);
+}
+
+static inline void fb_putc(FrameBuf *fb, char c)
+{
+    fb->data[fb->len++] = c;
+}
 
-    MapPlot *p = &zsf_MapCh_getcr(map, 0, 0, 0, 0),
-            *endp = p + (map->size.x * map->size.y);
+static inline void fb_putn(FrameBuf *fb, char const *s, z__size n)
+{
+    memcpy(fb->data + fb->len, s, n);
+    fb->len += n;
+}
 
-    while (p < endp && i < endi) {
-        *i = oft->color.bg[p->clr_bg].r;
-        i += 1;
-        *i = oft->color.bg[p->clr_bg].g;
-        i += 1;
-        *i = oft->color.bg[p->clr_bg].b;
-        i += 1;
+#define fb_puts(fb, lit) fb_putn(fb, lit, sizeof(lit) - 1)
 
-        p += 1;
+/* Decimal of a color channel, no leading zeros */
+static inline void fb_putu8(FrameBuf *fb, z__u8 v)
+{
+    char *d = fb->data + fb->len;
+    if(v >= 100) {
+        d[0] = '0' + v / 100;
+        d[1] = '0' + v / 10 % 10;
+        d[2] = '0' + v % 10;
+        fb->len += 3;
+    } else if(v >= 10) {
+        d[0] = '0' + v / 10;
+        d[1] = '0' + v % 10;
+        fb->len += 2;
+    } else {
+        d[0] = '0' + v;
+        fb->len += 1;
     }
+}
 
-    return img;
+void fb_flush(FrameBuf *fb)
+{
+    /* Anything already queued on stdout, like the cursor jump, goes first */
+    fflush(stdout);
+    z__size done = 0;
+    while(done < fb->len) {
+        ssize_t n = write(STDOUT_FILENO, fb->data + done, fb->len - done);
+        if(n <= 0) break;
+        done += n;
+    }
+    fb->len = 0;
+}
+
+static inline void fb_putu32(FrameBuf *fb, z__u32 v)
+{
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    } while(v);
+    while(n) fb_putc(fb, tmp[--n]);
 }
 
+/* Longest cell: "\x1b[48;2;255;255;255m " */
+enum { FrameCellMax = 20 };
+
 void draw_map_bgcolor(Map *map, OFormat *oft)
 {
-    MapPlot *p = map->chunks[0];
+    z__size p = 0;
+    ColorRGB last = {0};
+    int has_last = 0;
+    fb_reserve(&frame, (z__size)map->size.y * (map->size.x * FrameCellMax + 1));
     for (size_t i = 0; i < map->size.y; i++) {
         for (size_t j = 0; j < map->size.x; j++) {
-            ColorRGB *c = &oft->color.bg[p->clr_bg];
-            fprintf(
-                stdout
-                /*, z__ansi_fmt((cl256_bg, %d)) "%c", p->clr_bg,
-                    charlist.data[p->ch >= charlist.lenUsed?
-                                charlist.lenUsed-1:p->ch]);
-                */
-                  , z__ansi_fmt((clrgb_bg, %u, %u, %u)) "%c", c->r, c->g, c->b, ' ');
+            ColorRGB *c = &oft->color.bg[Map_clr(map, p)];
+            /* The background stays set across cells and line breaks, only emit changes */
+            if(!has_last || c->r != last.r || c->g != last.g || c->b != last.b) {
+                fb_puts(&frame, "\x1b[48;2;");
+                fb_putu8(&frame, c->r);
+                fb_putc(&frame, ';');
+                fb_putu8(&frame, c->g);
+                fb_putc(&frame, ';');
+                fb_putu8(&frame, c->b);
+                fb_putc(&frame, 'm');
+                last = *c;
+                has_last = 1;
+            }
+            fb_putc(&frame, ' ');
             p += 1;
         }
-        fputc('\n', stdout);
+        fb_putc(&frame, '\n');
     }
+    fb_flush(&frame);
 }
 
 void draw_map_char(Map *map, OFormat *oft)
 {
-    MapPlot *p = map->chunks[0];
+    z__size p = 0;
+    fb_reserve(&frame, (z__size)map->size.y * (map->size.x + 1));
     for (size_t i = 0; i < map->size.y; i++) {
         for (size_t j = 0; j < map->size.x; j++) {
-            fputc(oft->ch[p->ch], stdout);
+            fb_putc(&frame, oft->ch[Map_ch(map, p)]);
             p += 1;
         }
-        fputc('\n', stdout);
+        fb_putc(&frame, '\n');
     }
+    fb_flush(&frame);
+}
+
+/**
+ * Block Glyphs
+ * Half and quadrant blocks fit 1x2 or 2x2 samples in one cell, the glyph is
+ * drawn in the fg color and the rest of the cell in the bg. A quadrant mask
+ * has top left, top right, bottom left, bottom right from the lowest bit.
+ */
+static char const *const block_glyph[16] = {
+    " ",      "\u2598", "\u259D", "\u2580", "\u2596", "\u258C", "\u259E", "\u259B",
+    "\u2597", "\u259A", "\u2590", "\u259C", "\u2584", "\u2599", "\u259F", "\u2588",
+};
+
+typedef struct BlockCell {
+    ColorRGB fg, bg;
+    z__u8 mask;
+} BlockCell;
+
+/* Colors last set on the terminal */
+typedef struct SgrState {
+    ColorRGB fg, bg;
+    z__u8 has_fg, has_bg;
+} SgrState;
+
+/* Longest block cell, fg and bg escapes and a 3 byte glyph */
+enum { BlockCellMax = FrameCellMax * 2 + 3 };
+
+static inline int rgb_eq(ColorRGB a, ColorRGB b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
 }
 
-void gen_map2D(Map *map, OFormat *oft, fnl_state *noise, z__Vector3 start)
+static inline z__u32 rgb_dist2(ColorRGB a, ColorRGB b)
 {
-    z__size f = oft->color_lenUsed/2;
-    z__size g = oft->ch_lenUsed/2;
-    z__size x = 0, y = 0;
-    z__omp(parallel for private(x, y))
-        for (x = 0; x < map->size.x; x++) {
-            for (y = 0; y < map->size.y; y++) {
-                float n = fnlGetNoise2D(noise, start.x + x, start.y + y);
-                MapPlot plot = {
-                    .ch = fmod((n+1) * g,  oft->ch_lenUsed),
-                    .clr_bg = fmod((n+1.0) * f, oft->color_lenUsed),
-                };
-                zsf_MapCh_setcr(map, x, y, 0, 0, plot);
-            }
+    z__i32 r = a.r - b.r, g = a.g - b.g, bl = a.b - b.b;
+    return r * r + g * g + bl * bl;
+}
+
+/**
+ * Split the samples of cell (cx, cy) into the two colors furthest apart,
+ * every sample takes the nearer one. The fg always holds the top left sample.
+ */
+static inline BlockCell block_cell(Map *map, OFormat *oft, z__Vint2 samples, z__u32 cx, z__u32 cy)
+{
+    ColorRGB c[4];
+    for (z__u32 y = 0; y < 2; y++) {
+        z__size row = (z__size)(cy * samples.y + y * (samples.y - 1)) * map->size.x;
+        for (z__u32 x = 0; x < 2; x++) {
+            c[y * 2 + x] = oft->color.bg[Map_clr(map, row + cx * samples.x + x * (samples.x - 1))];
         }
+    }
+
+    z__u32 fi = 0, bi = 0, best = 0;
+    for (z__u32 i = 0; i < 4; i++) {
+        for (z__u32 j = i + 1; j < 4; j++) {
+            z__u32 d = rgb_dist2(c[i], c[j]);
+            if(d > best) { best = d; fi = i; bi = j; }
+        }
+    }
+    if(!best) return (BlockCell){.fg = c[0], .bg = c[0], .mask = 0};
+
+    BlockCell cell = {.fg = c[fi], .bg = c[bi]};
+    for (z__u32 i = 0; i < 4; i++) {
+        if(rgb_dist2(c[i], cell.fg) < rgb_dist2(c[i], cell.bg)) cell.mask |= 1 << i;
+    }
+    if(!(cell.mask & 1)) {
+        ColorRGB t = cell.fg;
+        cell.fg = cell.bg;
+        cell.bg = t;
+        cell.mask ^= 0xF;
+    }
+    return cell;
 }
 
-void gen_map3D(Map *map, OFormat *oft, fnl_state *noise, z__Vector3 start)
+static inline void fb_put_rgb(FrameBuf *fb, char layer, ColorRGB c)
 {
-    z__size f = oft->color_lenUsed/2;
-    z__size g = oft->ch_lenUsed/2;
-    z__size x = 0, y = 0;
-    z__omp(parallel for private(x, y))
-        for (x = 0; x < map->size.x; x++) {
-            for (y = 0; y < map->size.y; y++) {
-                float n = fnlGetNoise3D(noise, start.x + x, start.y + y, start.z);
-                MapPlot plot = {
-                    .ch = fmod((n+1) * g,  oft->ch_lenUsed),
-                    .clr_bg = fmod((n+1.0) * f, oft->color_lenUsed),
-                };
-                zsf_MapCh_setcr(map, x, y, 0, 0, plot);
-            }
+    fb_puts(fb, "\x1b[");
+    fb_putc(fb, layer);
+    fb_puts(fb, "8;2;");
+    fb_putu8(fb, c.r);
+    fb_putc(fb, ';');
+    fb_putu8(fb, c.g);
+    fb_putc(fb, ';');
+    fb_putu8(fb, c.b);
+    fb_putc(fb, 'm');
+}
+
+static inline void fb_put_block(FrameBuf *fb, BlockCell cell, SgrState *st)
+{
+    if(!st->has_bg || !rgb_eq(st->bg, cell.bg)) {
+        fb_put_rgb(fb, '4', cell.bg);
+        st->bg = cell.bg;
+        st->has_bg = 1;
+    }
+    if(cell.mask && (!st->has_fg || !rgb_eq(st->fg, cell.fg))) {
+        fb_put_rgb(fb, '3', cell.fg);
+        st->fg = cell.fg;
+        st->has_fg = 1;
+    }
+    char const *g = block_glyph[cell.mask];
+    fb_putn(fb, g, cell.mask? 3: 1);
+}
+
+static void draw_map_blocks(Map *map, OFormat *oft, z__Vint2 samples)
+{
+    z__u32 w = map->size.x / samples.x, h = map->size.y / samples.y;
+    SgrState st = {0};
+    fb_reserve(&frame, (z__size)h * (w * BlockCellMax + 1));
+    for (z__u32 y = 0; y < h; y++) {
+        for (z__u32 x = 0; x < w; x++) {
+            fb_put_block(&frame, block_cell(map, oft, samples, x, y), &st);
         }
+        fb_putc(&frame, '\n');
+    }
+    fb_flush(&frame);
+}
+
+void draw_map_half(Map *map, OFormat *oft)
+{
+    draw_map_blocks(map, oft, (z__Vint2){.x = 1, .y = 2});
 }
 
+void draw_map_quad(Map *map, OFormat *oft)
+{
+    draw_map_blocks(map, oft, (z__Vint2){.x = 2, .y = 2});
+}
 
+/**
+ * Terminal Palettes
+ * Indexed color output for terminals without truecolor. Every OFormat color is
+ * matched to its nearest terminal color once, the table is rebuilt only when
+ * the palette it was built from changed.
+ */
+typedef struct TermPalette {
+    z__u8 (*nearest)(ColorRGB);
+    ColorRGB *built;
+    z__u8 *idx;
+    z__size len, cap;
+} TermPalette;
+
+static z__u8 const xterm_cube[6] = {0, 95, 135, 175, 215, 255};
+
+static ColorRGB const ansi16[16] = {
+    {.raw = {  0,   0,   0}}, {.raw = {205,   0,   0}}, {.raw = {  0, 205,   0}}, {.raw = {205, 205,   0}},
+    {.raw = {  0,   0, 238}}, {.raw = {205,   0, 205}}, {.raw = {  0, 205, 205}}, {.raw = {229, 229, 229}},
+    {.raw = {127, 127, 127}}, {.raw = {255,   0,   0}}, {.raw = {  0, 255,   0}}, {.raw = {255, 255,   0}},
+    {.raw = { 92,  92, 255}}, {.raw = {255,   0, 255}}, {.raw = {  0, 255, 255}}, {.raw = {255, 255, 255}},
+};
 
-#if 0
-void gen_map_seg(Map *map, z__Vint2 end, OFormat *oft, fnl_state *noise, int startx, int starty)
-{
-    z__size f = oft->color_lenUsed;
-    z__size g = oft->ch_lenUsed;
-    z__size x = 0, y = 0;
-    end.x = z__util_min_unsafe(end.x, map->size.x);
-    end.y = z__util_min_unsafe(end.y, map->size.y);
-
-    z__omp(parallel for private(x, y))
-        for (x = 0; x < end.x; x++) {
-            for (y = 0; y < end.y; y++) {
-                float n = fnlGetNoise2D(noise, startx + x, starty + y);
-                MapPlot plot = {
-                    .ch = z__u32((n+1) * g/2) % g,
-                    .clr_bg = fmod(((n+1.0) * f/2.0), f),
-                };
-                zsf_MapCh_setcr(map, x, y, 0, 0, plot);
-            }
+static z__u8 xterm_cube_level(z__u8 v)
+{
+    return v < 48? 0: v < 115? 1: (v - 35) / 40;
+}
+
+/* Nearest of the 6x6x6 cube and the 24 step gray ramp */
+static z__u8 xterm256_nearest(ColorRGB c)
+{
+    z__u8 r = xterm_cube_level(c.r), g = xterm_cube_level(c.g), b = xterm_cube_level(c.b);
+    ColorRGB cube = {.raw = {xterm_cube[r], xterm_cube[g], xterm_cube[b]}};
+
+    z__u32 avg = (c.r + c.g + c.b) / 3;
+    z__u32 gi = avg < 8? 0: avg > 238? 23: (avg - 3) / 10;
+    z__u8 gv = 8 + gi * 10;
+    ColorRGB gray = {.raw = {gv, gv, gv}};
+
+    if(rgb_dist2(c, gray) < rgb_dist2(c, cube)) return 232 + gi;
+    return 16 + r * 36 + g * 6 + b;
+}
+
+static z__u8 ansi16_nearest(ColorRGB c)
+{
+    z__u8 best = 0;
+    z__u32 bd = -1;
+    for (z__u8 i = 0; i < 16; i++) {
+        z__u32 d = rgb_dist2(c, ansi16[i]);
+        if(d < bd) { bd = d; best = i; }
+    }
+    return best;
+}
+
+static TermPalette term256 = {.nearest = xterm256_nearest};
+static TermPalette term16 = {.nearest = ansi16_nearest};
+
+z__u8 const *TermPalette_get(TermPalette *tp, OFormat const *oft)
+{
+    z__size len = oft->color_lenUsed;
+    if(len == tp->len && tp->built && !memcmp(tp->built, oft->color.bg, len * sizeof(*tp->built))) {
+        return tp->idx;
+    }
+    if(len > tp->cap) {
+        tp->cap = len;
+        tp->built = z__REALLOC(tp->built, len * sizeof(*tp->built));
+        tp->idx = z__REALLOC(tp->idx, len * sizeof(*tp->idx));
+    }
+    for (z__size i = 0; i < len; i++) {
+        tp->built[i] = oft->color.bg[i];
+        tp->idx[i] = tp->nearest(oft->color.bg[i]);
+    }
+    tp->len = len;
+    return tp->idx;
+}
+
+/* Longest indexed cell: "\x1b[48;5;255m " */
+static inline void fb_put_bgidx(FrameBuf *fb, TermPalette const *tp, z__u8 i)
+{
+    if(tp == &term16) {
+        fb_puts(fb, "\x1b[");
+        if(i < 8) fb_putc(fb, '4');
+        else { fb_puts(fb, "10"); i -= 8; }
+        fb_putc(fb, '0' + i);
+        fb_putc(fb, 'm');
+    } else {
+        fb_puts(fb, "\x1b[48;5;");
+        fb_putu8(fb, i);
+        fb_putc(fb, 'm');
+    }
+}
+
+/* Cells from..upto of map in indexed colors, setting the color only on changes */
+static void fb_put_indexed(FrameBuf *fb, TermPalette const *tp, Map *map, z__size from, z__size upto, int *last)
+{
+    for (z__size p = from; p < upto; p++) {
+        int i = tp->idx[Map_clr(map, p)];
+        if(i != *last) {
+            fb_put_bgidx(fb, tp, i);
+            *last = i;
         }
+        fb_putc(fb, ' ');
+    }
 }
-#endif
 
-void explorer(Map *map, OFormat *oft, fnl_state *noise, Drawfn draw, GenMapFn gen, z__Vector3 at)
+static void draw_map_indexed(Map *map, OFormat *oft, TermPalette *tp)
 {
-    struct {
-        z__u8
-            cont:1;
-    } exp = {
-        .cont = 1,
-    };
+    int last = -1;
+    TermPalette_get(tp, oft);
+    fb_reserve(&frame, (z__size)map->size.y * (map->size.x * FrameCellMax + 1));
+    for (z__size y = 0; y < map->size.y; y++) {
+        fb_put_indexed(&frame, tp, map, y * map->size.x, (y + 1) * map->size.x, &last);
+        fb_putc(&frame, '\n');
+    }
+    fb_flush(&frame);
+}
 
-    z__Vector3 vel = {0};
+void draw_map_bg256(Map *map, OFormat *oft)
+{
+    draw_map_indexed(map, oft, &term256);
+}
 
-    char key = 0;
+void draw_map_bg16(Map *map, OFormat *oft)
+{
+    draw_map_indexed(map, oft, &term16);
+}
 
-    fputs(z__ansi_scr((cur_hide), (jump), (clear)), stdout);
-    z__termio_echo(false);
-    while(key != 'q') {
-        switch(key) {
-            break; case 'w': vel.y--;
-            break; case 's': vel.y++;
-            break; case 'a': vel.x--;
-            break; case 'd': vel.x++;
+static TermPalette *draw_term_palette(Drawfn *draw)
+{
+    if(draw == draw_map_bg256) return &term256;
+    if(draw == draw_map_bg16) return &term16;
+    return NULL;
+}
 
-            break; case 'W': vel.y -= 4;
-            break; case 'S': vel.y += 4;
-            break; case 'A': vel.x -= 4;
-            break; case 'D': vel.x += 4;
+/* Map samples per terminal cell of a draw method */
+z__Vint2 draw_samples(Drawfn *draw)
+{
+    if(draw == draw_map_half) return (z__Vint2){.x = 1, .y = 2};
+    if(draw == draw_map_quad) return (z__Vint2){.x = 2, .y = 2};
+    return (z__Vint2){.x = 1, .y = 1};
+}
 
-            break; case 'z': vel.z--;
-            break; case 'x': vel.z++;
+/**
+ * Screen
+ * What explorer last put on the terminal, one key per cell. New frames are
+ * diffed against it and only the changed spans are rewritten, the whole frame
+ * is repainted when it is new, the draw method changed or too much of it did.
+ */
+typedef struct Screen {
+    /* Keys of terminal cells, the map may have more samples than that */
+    z__u64 *shown, *next;
+    z__Vint2 size;
+    Drawfn *draw;
+    z__u8 valid;
+} Screen;
+
+enum {
+    /* Unchanged cells shorter than a cursor move are rewritten rather than skipped */
+    ScreenGapMerge = 8,
+    /* Repaint everything once more than 1/ScreenRepaintDiv of the cells changed */
+    ScreenRepaintDiv = 2,
+};
 
-            break; case 'Z': vel.z -= 4;
-            break; case 'X': vel.z += 4;
+void Screen_delete(Screen *scr)
+{
+    z__FREE(scr->shown);
+    z__FREE(scr->next);
+    memset(scr, 0, sizeof(*scr));
+}
 
-            break; case '[': gen = gen_map2D;
-            break; case ']': gen = gen_map3D;
+void Screen_invalidate(Screen *scr)
+{
+    scr->valid = 0;
+}
 
-            break; case '1': draw = draw_map_char;
-            break; case '2': draw = draw_map_bgcolor;
+static inline z__u64 rgb_key(ColorRGB c)
+{
+    return c.r << 16 | c.g << 8 | c.b;
+}
 
-            break; case ':': {
-                fputs(z__ansi_scr((cur_show))":", stdout);
-                z__termio_echo(true); z__termio_getkey_nowait();
-                switch(z__termio_getkey()) {
-                    break; case 'c': exp.cont = !exp.cont;
-                    break; case 'n': {
-                        char tmp[12] = { [11] = 0 };
-                        char tmp2[96] = { [95] = 0};
-                        scanf("%11s %95s", tmp, tmp2);
-                        int set_noise_argparse(fnl_state *noise, const char *arg0, const char *arg1);
-                        set_noise_argparse(noise, tmp, tmp2);
-                    }
+static inline z__u64 screen_key(Map *map, OFormat *oft, Drawfn *draw, TermPalette const *tp, z__Vint2 samples, z__u32 x, z__u32 y)
+{
+    if(samples.x > 1 || samples.y > 1) {
+        BlockCell cell = block_cell(map, oft, samples, x, y);
+        return 2ull << 56 | (z__u64)cell.mask << 48 | rgb_key(cell.fg) << 24 | rgb_key(cell.bg);
+    }
+    z__size i = (z__size)y * map->size.x + x;
+    if(draw == draw_map_char) {
+        return oft->ch[Map_ch(map, i)];
+    }
+    if(tp) {
+        return 3ull << 32 | tp->idx[Map_clr(map, i)];
+    }
+    return 1ull << 32 | rgb_key(oft->color.bg[Map_clr(map, i)]);
+}
 
-                    break; case 'l': {
-                        char tmp[128];
-                        oft_command_parse(fgets(tmp, 127, stdin), oft);
-                    }
+static void screen_emit_span(Map *map, OFormat *oft, Drawfn *draw, TermPalette const *tp, z__Vint2 samples, z__u32 y, z__u32 x0, z__u32 x1)
+{
+    fb_puts(&frame, "\x1b[");
+    fb_putu32(&frame, y + 1);
+    fb_putc(&frame, ';');
+    fb_putu32(&frame, x0 + 1);
+    fb_putc(&frame, 'H');
+
+    if(samples.x > 1 || samples.y > 1) {
+        SgrState st = {0};
+        for (z__u32 x = x0; x < x1; x++) fb_put_block(&frame, block_cell(map, oft, samples, x, y), &st);
+        return;
+    }
 
-                    break; case 'h': fputs(
-                            z__ansi_scr((jump), (clear))
-                            "Color:\n"
-                            HELP_TXT_COLOR
-                            "\n"
-                            "Fnl Noise:\n"
-                            HELP_TXT_NOISE
-                            "\n"
-                            "\n", stdout);
+    z__size p = (z__size)y * map->size.x + x0;
+    if(draw == draw_map_char) {
+        for (z__u32 x = x0; x < x1; x++, p++) fb_putc(&frame, oft->ch[Map_ch(map, p)]);
+        return;
+    }
+    if(tp) {
+        int last = -1;
+        fb_put_indexed(&frame, tp, map, p, p + (x1 - x0), &last);
+        return;
+    }
 
-                    break; default: 
-                        fputs("Not a Valid Command\n", stdout);
-                }
-                fputs("Press Any Key\n", stdout);
-                z__termio_getkey();
-                z__termio_echo(false);
-                fputs(z__ansi_scr((cur_hide), (jump), (clear)), stdout);
-            }
+    /* Every span sets its first color, earlier spans may have ended on anything */
+    z__size last = -1;
+    for (z__u32 x = x0; x < x1; x++, p++) {
+        z__size idx = Map_clr(map, p);
+        if(idx != last) {
+            ColorRGB *c = &oft->color.bg[idx];
+            fb_puts(&frame, "\x1b[48;2;");
+            fb_putu8(&frame, c->r);
+            fb_putc(&frame, ';');
+            fb_putu8(&frame, c->g);
+            fb_putc(&frame, ';');
+            fb_putu8(&frame, c->b);
+            fb_putc(&frame, 'm');
+            last = idx;
         }
+        fb_putc(&frame, ' ');
+    }
+}
 
-        z__Vector3_A(at, vel, +, &at);
-        if(!exp.cont) {
-            vel.raw[0] = 0;
-            vel.raw[1] = 0;
-            vel.raw[2] = 0;
-        }
+/**
+ * Put the map on the terminal, starting at the top left corner.
+ */
+void screen_present(Screen *scr, Map *map, OFormat *oft, Drawfn *draw)
+{
+    z__Vint2 samples = draw_samples(draw);
+    z__Vint2 size = {.x = map->size.x / samples.x, .y = map->size.y / samples.y};
+    TermPalette *tp = draw_term_palette(draw);
+    if(tp) TermPalette_get(tp, oft);
+    z__size cells = (z__size)size.x * size.y;
+    if(scr->size.x != size.x || scr->size.y != size.y) {
+        scr->shown = z__REALLOC(scr->shown, cells * sizeof(*scr->shown));
+        scr->next = z__REALLOC(scr->next, cells * sizeof(*scr->next));
+        scr->size = size;
+        scr->valid = 0;
+    }
+    if(scr->draw != draw) {
+        scr->draw = draw;
+        scr->valid = 0;
+    }
 
-        gen(map, oft, noise, at);
+    z__size changed = 0;
+    for (z__u32 y = 0; y < size.y; y++) {
+        for (z__u32 x = 0; x < size.x; x++) {
+            z__size i = (z__size)y * size.x + x;
+            scr->next[i] = screen_key(map, oft, draw, tp, samples, x, y);
+            changed += scr->next[i] != scr->shown[i];
+        }
+    }
 
+    if(!scr->valid || changed * ScreenRepaintDiv > cells) {
         fputs(z__ansi_scr((jump)), stdout);
         draw(map, oft);
         fputs(z__ansi_fmt((plain)), stdout);
-
-        key = z__termio_getkey_nowait();
-        z__time_msleep(40);
+        fflush(stdout);
+    } else if(changed) {
+        fb_reserve(&frame, cells * (BlockCellMax + 16));
+        for (z__u32 y = 0; y < size.y; y++) {
+            z__u64 const *a = scr->shown + (z__size)y * size.x;
+            z__u64 const *b = scr->next + (z__size)y * size.x;
+            z__u32 x = 0;
+            while (x < size.x) {
+                if(a[x] == b[x]) { x++; continue; }
+
+                z__u32 x0 = x, x1 = x + 1;
+                for (x = x1; x < size.x && x - x1 < ScreenGapMerge; x++) {
+                    if(a[x] != b[x]) x1 = x + 1;
+                }
+                screen_emit_span(map, oft, draw, tp, samples, y, x0, x1);
+            }
+        }
+        fb_puts(&frame, z__ansi_fmt((plain)));
+        fb_flush(&frame);
     }
-    fputs(z__ansi_scr((cur_show)), stdout);
-    z__termio_echo(true);
 
-    fprintf(stdout, "x - %f\n"
-                    "y - %f\n"
-                    "z = %f\n", at.x, at.y, at.z);
+    z__u64 *tmp = scr->shown;
+    scr->shown = scr->next;
+    scr->next = tmp;
+    scr->valid = 1;
 }
 
-void print_state_details(struct ne_state *ne, OFormat *oft, Map *map)
+enum { FieldAlign = 64 };
+
+Field Field_new(z__Vint2 size)
+{
+    z__size sz = sizeof(float) * size.x * size.y;
+    sz = (sz + FieldAlign - 1) / FieldAlign * FieldAlign;
+    Field field = {
+        .size = size,
+        .data = aligned_alloc(FieldAlign, sz? sz: FieldAlign),
+    };
+    if(!field.data) die("Field Not Allocated");
+    return field;
+}
+
+void Field_free(Field *field)
+{
+    free(field->data);
+    memset(field, 0, sizeof(*field));
+}
+
+MapRect Field_rect(Field const *field)
+{
+    return (MapRect){.w = field->size.x, .h = field->size.y};
+}
+
+/**
+ * Noise to palette index mapping, built once per generated frame.
+ * A noise value n lands on floor((n+1) * len/2) wrapped into [0, len), the
+ * same as the old per cell fmod, but with a truncate and a conditional subtract.
+ */
+typedef struct Quantizer {
+    float ch_scale;
+    double clr_scale;
+    z__u32 ch_len, clr_len;
+} Quantizer;
+
+Quantizer quantizer_new(OFormat const *oft)
+{
+    return (Quantizer){
+        .ch_scale = oft->ch_lenUsed/2,
+        .clr_scale = oft->color_lenUsed/2,
+        .ch_len = oft->ch_lenUsed,
+        .clr_len = oft->color_lenUsed,
+    };
+}
+
+static inline z__u32 quantize_wrap(z__u32 i, z__u32 len)
+{
+    i -= i >= len? len: 0;
+    /* Only values past 2*len, e.g. cellular distances, need the divide */
+    if(i >= len) i = len? i % len: 0;
+    return i;
+}
+
+void quantize_row(Quantizer const *q, float const *row, z__u32 *ch, z__u32 *clr, z__size count)
+{
+    for (z__size i = 0; i < count; i++) {
+        float c = (row[i] + 1) * q->ch_scale;
+        double b = (row[i] + 1.0) * q->clr_scale;
+        ch[i] = c > 0? (z__u32)c: 0;
+        clr[i] = b > 0? (z__u32)b: 0;
+    }
+    for (z__size i = 0; i < count; i++) {
+        ch[i] = quantize_wrap(ch[i], q->ch_len);
+        clr[i] = quantize_wrap(clr[i], q->clr_len);
+    }
+}
+
+/**
+ * Generators fill whole rows in storage order, one noise row call each, and
+ * share the rows out between threads. A thread writes contiguous rows, only the
+ * ends of its block can share a cache line with another thread.
+ */
+
+void gen_map2D(Field *field, fnl_state *noise, z__Vector3 start, MapRect rect)
+{
+    z__size y = 0;
+    z__omp(parallel for private(y))
+        for (y = rect.y; y < rect.y + rect.h; y++) {
+            float *row = field->data + rect.x + y * field->size.x;
+            fnlGetNoiseRow2D(noise, row, rect.w, start.x + rect.x, start.y + y, 1);
+        }
+}
+
+void gen_map3D(Field *field, fnl_state *noise, z__Vector3 start, MapRect rect)
+{
+    z__size y = 0;
+    z__omp(parallel for private(y))
+        for (y = rect.y; y < rect.y + rect.h; y++) {
+            float *row = field->data + rect.x + y * field->size.x;
+            fnlGetNoiseRow3D(noise, row, rect.w, start.x + rect.x, start.y + y, start.z, 1);
+        }
+}
+
+/* Rows are quantized this many cells at a time, through indices on the stack */
+enum { QuantizeChunkW = 512 };
+
+/**
+ * Map the field onto palette and charlist indices of the map, within rect.
+ * The planes must already fit oft, they are never reallocated here, so the map
+ * may point into memory it does not own.
+ */
+void map_quantize_fitted(Map *map, Field *field, OFormat *oft, MapRect rect)
+{
+    Quantizer q = quantizer_new(oft);
+    z__size y = 0;
+    z__omp(parallel for private(y))
+        for (y = rect.y; y < rect.y + rect.h; y++) {
+            z__u32 ch[QuantizeChunkW], clr[QuantizeChunkW];
+            z__size at = y * field->size.x;
+
+            for (z__size x0 = rect.x; x0 < rect.x + rect.w; x0 += QuantizeChunkW) {
+                z__size w = z__util_min_unsafe(QuantizeChunkW, rect.x + rect.w - x0);
+                quantize_row(&q, field->data + at + x0, ch, clr, w);
+                Map_index_set(map->ch, map->ch_bytes, at + x0, ch, w);
+                Map_index_set(map->clr, map->clr_bytes, at + x0, clr, w);
+            }
+        }
+}
+
+/* As map_quantize_fitted, widening or narrowing the planes to fit oft first */
+void map_quantize(Map *map, Field *field, OFormat *oft, MapRect rect)
+{
+    Map_fit(map, oft);
+    map_quantize_fitted(map, field, oft, rect);
+}
+
+/**
+ * Export
+ * Images go out a band of rows at a time, so neither the pixels nor the encoded
+ * image are ever held whole. A band is at least ExportBandH rows and about
+ * ExportBandBytes of pixels, enough PNG segments for every thread to deflate one.
+ *
+ * ExportRGB writes palette background colors as PNG, gray16 and hdr take the
+ * noise field itself as a 16 bit grayscale PNG and as Radiance RGBE, both
+ * mapping [-1, 1] onto [0, 1]. The raw formats are under Raw Output.
+ */
+enum { ExportBandH = 64, ExportBandBytes = 8 << 20, ExportPathMax = 4096 };
+
+typedef struct Export {
+    FILE *fp;
+    ExportFormat format;
+    OFormat *oft;
+    stbi_png_stream png;
+    z__u8 *buf;
+    z__u32 width, band_h;
+} Export;
+
+static void export_write_file(void *context, void *data, int size)
+{
+    fwrite(data, 1, size, context);
+}
+
+static Export export_begin(char const *path, z__Vint2 size, ExportFormat format, OFormat *oft)
+{
+    Export ex = {.fp = fopen(path, "wb"), .format = format, .oft = oft, .width = size.x};
+    if(!ex.fp) die("Image Not Written");
+
+    int ok = 1;
+    switch(format) {
+        break; case ExportRGB:
+            ok = stbi_write_png_stream_begin(&ex.png, export_write_file, ex.fp, size.x, size.y, 3);
+        break; case ExportGray16:
+            ok = stbi_write_png_16_stream_begin(&ex.png, export_write_file, ex.fp, size.x, size.y, 1);
+        break; case ExportHDR:
+            ok = stbi_write_hdr_stream_begin(export_write_file, ex.fp, size.x, size.y);
+        break; default: ok = 0;
+    }
+    if(!ok) die("Image Not Written");
+
+    /* An empty image has no rows to band */
+    ex.band_h = size.x? z__util_max_unsafe(ExportBandH, ExportBandBytes / ((z__size)size.x * 3)): ExportBandH;
+    ex.band_h = z__util_min_unsafe(ex.band_h, (z__u32)size.y);
+    ex.buf = z__MALLOC((z__size)size.x * ex.band_h * 4);
+    return ex;
+}
+
+/* Map [-1, 1] onto [0, 1] */
+static inline float export_unit(float n)
+{
+    return (n + 1) * 0.5f;
+}
+
+/* Write `rows` rows, from map for ExportRGB and from field otherwise, both starting at row y0 */
+static void export_rows(Export *ex, Map *map, Field *field, z__u32 y0, z__u32 rows)
+{
+    z__size w = ex->width, y = 0;
+    float const *src = field? field->data + y0 * w: NULL;
+    int ok = 1;
+
+    switch(ex->format) {
+        break; case ExportRGB: {
+            z__omp(parallel for private(y))
+                for (y = 0; y < rows; y++) {
+                    z__size at = (y0 + y) * w;
+                    z__u8 *i = ex->buf + y * w * 3;
+                    for (z__size x = 0; x < w; x++) {
+                        ColorRGB c = ex->oft->color.bg[Map_clr(map, at + x)];
+                        i[0] = c.r;
+                        i[1] = c.g;
+                        i[2] = c.b;
+                        i += 3;
+                    }
+                }
+            ok = stbi_write_png_stream_rows(&ex->png, ex->buf, rows, 0);
+        }
+        break; case ExportGray16: {
+            z__omp(parallel for private(y))
+                for (y = 0; y < rows; y++) {
+                    z__u8 *o = ex->buf + y * w * 2;
+                    for (z__size x = 0; x < w; x++) {
+                        float v = export_unit(src[y * w + x]) * 65535 + 0.5f;
+                        z__u16 g = v <= 0? 0: v >= 65535? 65535: (z__u16)v;
+                        o[x * 2] = g >> 8;
+                        o[x * 2 + 1] = g;
+                    }
+                }
+            ok = stbi_write_png_stream_rows(&ex->png, ex->buf, rows, 0);
+        }
+        break; case ExportHDR: {
+            float *o = (float *)ex->buf;
+            z__size cells = rows * w, i = 0;
+            z__omp(parallel for private(i))
+                for (i = 0; i < cells; i++) {
+                    float v = export_unit(src[i]);
+                    o[i] = v > 0? v: 0;
+                }
+            ok = stbi_write_hdr_stream_rows(export_write_file, ex->fp, w, rows, 1, o);
+        }
+        break; default: ok = 0;
+    }
+    if(!ok) die("Image Not Written");
+}
+
+static void export_end(Export *ex)
+{
+    int ok = 1;
+    if(ex->format == ExportRGB || ex->format == ExportGray16) ok = stbi_write_png_stream_end(&ex->png);
+    ok &= !ferror(ex->fp);
+    ok &= !fclose(ex->fp);
+    z__FREE(ex->buf);
+    if(!ok) die("Image Not Written");
+}
+
+/**
+ * Raw Output
+ * f32 and idx files are made at their final size and mapped, the generator
+ * writes straight into the mapping and nothing is encoded. Readers mmap them
+ * back the same way: a RawHeader, then the data at header_size.
+ * RawF32 data is the noise field as floats, RawIndex data the palette index
+ * plane followed by the charlist index plane, clr_bytes and ch_bytes per cell.
+ * Everything is in host byte order, byte_order reads 0x01020304 on the host.
+ */
+typedef struct RawHeader {
+    char magic[4];
+    z__u32 version, header_size;
+    z__u32 width, height;
+    z__u32 type, byte_order;
+    z__u32 clr_bytes, ch_bytes, clr_len, ch_len;
+
+    /* Noise the data was made from */
+    z__u32 gen3d;
+    float start[3];
+    z__i32 seed;
+    float frequency;
+    z__u32 noise_type, rotation_type_3d, fractal_type;
+    z__i32 octaves;
+    float lacunarity, gain, weighted_strength, ping_pong_strength;
+    z__u32 cellular_distance_func, cellular_return_type;
+    float cellular_jitter_mod;
+} RawHeader;
+
+/* Data starts here, cache line aligned */
+enum { RawVersion = 2, RawHeaderSize = 128, RawF32 = 1, RawIndex = 2 };
+
+typedef struct RawFile {
+    z__u8 *base;
+    z__size len;
+} RawFile;
+
+RawHeader raw_header(z__Vint2 size, ExportFormat format, Map const *map, OFormat const *oft
+        , fnl_state const *noise, GenMapFn gen, z__Vector3 start)
+{
+    RawHeader h = {
+        .magic = "neRW",
+        .version = RawVersion, .header_size = RawHeaderSize,
+        .width = size.x, .height = size.y,
+        .type = format == ExportF32? RawF32: RawIndex,
+        .byte_order = 0x01020304,
+        .gen3d = gen == gen_map3D,
+        .start = {start.x, start.y, start.z},
+        .seed = noise->seed, .frequency = noise->frequency,
+        .noise_type = noise->noise_type, .rotation_type_3d = noise->rotation_type_3d,
+        .fractal_type = noise->fractal_type, .octaves = noise->octaves,
+        .lacunarity = noise->lacunarity, .gain = noise->gain,
+        .weighted_strength = noise->weighted_strength,
+        .ping_pong_strength = noise->ping_pong_strength,
+        .cellular_distance_func = noise->cellular_distance_func,
+        .cellular_return_type = noise->cellular_return_type,
+        .cellular_jitter_mod = noise->cellular_jitter_mod,
+    };
+    if(format == ExportIndex) {
+        h.clr_bytes = map->clr_bytes;
+        h.ch_bytes = map->ch_bytes;
+        h.clr_len = oft->color_lenUsed;
+        h.ch_len = oft->ch_lenUsed;
+    }
+    return h;
+}
+
+z__size raw_data_size(RawHeader const *h)
+{
+    z__size cells = (z__size)h->width * h->height;
+    return h->type == RawF32? cells * sizeof(float): cells * (h->clr_bytes + h->ch_bytes);
+}
+
+/* Create path at its final size and map it, with the header already in place */
+RawFile raw_create(char const *path, RawHeader const *h)
+{
+    RawFile raw = {.len = RawHeaderSize + raw_data_size(h)};
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) die("Image Not Written");
+    if(ftruncate(fd, raw.len)) die("Image Not Written");
+    raw.base = mmap(NULL, raw.len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(raw.base == MAP_FAILED) die("Image Not Written");
+    memcpy(raw.base, h, sizeof(*h));
+    return raw;
+}
+
+void raw_close(RawFile *raw)
+{
+    if(munmap(raw->base, raw->len)) die("Image Not Written");
+    *raw = (RawFile){0};
+}
+
+/* Index planes of a size map kept in raw, row y0 on */
+static Map raw_map_rows(RawFile *raw, RawHeader const *h, z__u32 y0, z__u32 rows)
+{
+    z__size cells = (z__size)h->width * h->height, at = (z__size)y0 * h->width;
+    z__u8 *clr = raw->base + RawHeaderSize;
+    return (Map){
+        .size = {.x = h->width, .y = rows},
+        .clr = clr + at * h->clr_bytes, .clr_bytes = h->clr_bytes,
+        .ch = clr + cells * h->clr_bytes + at * h->ch_bytes, .ch_bytes = h->ch_bytes,
+    };
+}
+
+/* Write map or the field behind it, from noise at start, in format */
+void export_map(char const *path, Map *map, Field *field, OFormat *oft, ExportFormat format
+        , fnl_state *noise, GenMapFn gen, z__Vector3 start)
+{
+    if(format == ExportF32 || format == ExportIndex) {
+        RawHeader h = raw_header(map->size, format, map, oft, noise, gen, start);
+        RawFile raw = raw_create(path, &h);
+        if(format == ExportF32) {
+            memcpy(raw.base + RawHeaderSize, field->data, raw_data_size(&h));
+        } else {
+            /* Planes go in as they are, the header took their widths from map */
+            z__size cells = (z__size)h.width * h.height;
+            z__u8 *data = raw.base + RawHeaderSize;
+            memcpy(data, map->clr, cells * h.clr_bytes);
+            memcpy(data + cells * h.clr_bytes, map->ch, cells * h.ch_bytes);
+        }
+        raw_close(&raw);
+        return;
+    }
+
+    Export ex = export_begin(path, map->size, format, oft);
+    for (z__u32 y = 0; y < map->size.y; y += ex.band_h) {
+        export_rows(&ex, map, field, y, z__util_min_unsafe(ex.band_h, map->size.y - y));
+    }
+    export_end(&ex);
+}
+
+/* Generate a size map at start straight into the file, band by band unless raw */
+void export_gen(char const *path, z__Vint2 size, fnl_state *noise, GenMapFn gen, z__Vector3 start
+        , OFormat *oft, ExportFormat format)
+{
+    if(format == ExportF32) {
+        RawHeader h = raw_header(size, format, NULL, oft, noise, gen, start);
+        RawFile raw = raw_create(path, &h);
+        Field field = {.data = (float *)(raw.base + RawHeaderSize), .size = size};
+        gen(&field, noise, start, Field_rect(&field));
+        raw_close(&raw);
+        return;
+    }
+    if(format == ExportIndex) {
+        Map fit = {
+            .ch_bytes = Map_index_bytes(oft->ch_lenUsed),
+            .clr_bytes = Map_index_bytes(oft->color_lenUsed),
+        };
+        RawHeader h = raw_header(size, format, &fit, oft, noise, gen, start);
+        RawFile raw = raw_create(path, &h);
+
+        z__u32 band_h = z__util_min_unsafe(ExportBandH, (z__u32)size.y);
+        Field field = Field_new((z__Vint2){.x = size.x, .y = band_h});
+        for (z__u32 y = 0; y < size.y; y += band_h) {
+            MapRect rect = {.w = size.x, .h = z__util_min_unsafe(band_h, size.y - y)};
+            z__Vector3 at = {.x = start.x, .y = start.y + y, .z = start.z};
+            Map rows = raw_map_rows(&raw, &h, y, rect.h);
+            gen(&field, noise, at, rect);
+            map_quantize_fitted(&rows, &field, oft, rect);
+        }
+        Field_free(&field);
+        raw_close(&raw);
+        return;
+    }
+
+    Export ex = export_begin(path, size, format, oft);
+    z__Vint2 band = {.x = size.x, .y = ex.band_h};
+    Field field = Field_new(band);
+    /* Only palette colors go through a map */
+    Map map = format == ExportRGB? Map_new(band): (Map){0};
+
+    for (z__u32 y = 0; y < size.y; y += ex.band_h) {
+        MapRect rect = {.w = size.x, .h = z__util_min_unsafe(ex.band_h, size.y - y)};
+        z__Vector3 at = {.x = start.x, .y = start.y + y, .z = start.z};
+        gen(&field, noise, at, rect);
+        if(format == ExportRGB) map_quantize(&map, &field, oft, rect);
+        export_rows(&ex, &map, &field, 0, rect.h);
+    }
+    export_end(&ex);
+    Map_delete(&map);
+    Field_free(&field);
+}
+
+/**
+ * Mip Pyramid
+ * Level l is level l-1 halved, rounding down and never under a pixel, and goes
+ * to the written path with ".l" before its extension. Colors are averaged for
+ * rgb, every other format resizes the noise field itself and requantizes it.
+ *
+ * A level depends on the one before it, so each resize is split in strips of
+ * MipStripH output rows run in parallel instead. Strips are fixed in size, the
+ * result does not depend on the thread count. Levels are written in parallel.
+ */
+enum { MipStripH = 64 };
+
+static z__Vint2 mip_size(z__Vint2 size)
+{
+    return (z__Vint2){.x = z__util_max_unsafe(size.x / 2, 1), .y = z__util_max_unsafe(size.y / 2, 1)};
+}
+
+/* path with ".level" put before its extension */
+static void mip_path(char *buf, char const *path, z__u32 level)
+{
+    char const *dot = strrchr(path, '.'), *slash = strrchr(path, '/');
+    int len = dot && (!slash || dot > slash)? dot - path: (int)strlen(path);
+    if(snprintf(buf, ExportPathMax, "%.*s.%u%s", len, path, level, path + len) >= ExportPathMax)
+        die("Image Not Written");
+}
+
+/* Resize pixels of a size image into a next sized one, strip by strip */
+static void mip_resize(void const *src, z__Vint2 size, void *dst, z__Vint2 next
+        , stbir_datatype type, z__u32 channels)
+{
+    z__size pixel_bytes = channels * (type == STBIR_TYPE_FLOAT? sizeof(float): 1);
+    z__i32 strips = (next.y + MipStripH - 1) / MipStripH, i = 0;
+    z__omp(parallel for schedule(dynamic) private(i))
+        for (i = 0; i < strips; i++) {
+            z__i32 y0 = i * MipStripH, y1 = z__util_min_unsafe(y0 + MipStripH, next.y);
+            stbir_resize_region(src, size.x, size.y, 0
+                    , (z__u8 *)dst + (z__size)y0 * next.x * pixel_bytes, next.x, y1 - y0, 0
+                    , type, channels, STBIR_ALPHA_CHANNEL_NONE, 0
+                    , STBIR_EDGE_CLAMP, STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT, STBIR_FILTER_DEFAULT
+                    , STBIR_COLORSPACE_LINEAR, NULL
+                    , 0, (float)y0 / next.y, 1, (float)y1 / next.y);
+        }
+}
+
+void export_mips(struct ne_state *ne, Map *map, Field *field, OFormat *oft)
+{
+    z__u32 levels = ne->mips, l = 0;
+    char path[ExportPathMax];
+
+    if(ne->format == ExportRGB) {
+        Image *img = z__MALLOC(sizeof(*img) * (levels + 1));
+        img[0] = Image_newFrom_map(map, oft);
+        for (l = 1; l <= levels; l++) {
+            img[l] = Image_new(mip_size(img[l-1].size), 3);
+            mip_resize(img[l-1].data, img[l-1].size, img[l].data, img[l].size, STBIR_TYPE_UINT8, 3);
+        }
+        z__omp(parallel for schedule(dynamic) private(l, path))
+            for (l = 1; l <= levels; l++) {
+                mip_path(path, ne->write_to_file_name, l);
+                Image_write_png(path, &img[l]);
+            }
+        for (l = 0; l <= levels; l++) Image_free(&img[l]);
+        z__FREE(img);
+        return;
+    }
+
+    Field *f = z__MALLOC(sizeof(*f) * (levels + 1));
+    Map *m = z__MALLOC(sizeof(*m) * (levels + 1));
+    f[0] = *field;
+    for (l = 1; l <= levels; l++) {
+        f[l] = Field_new(mip_size(f[l-1].size));
+        mip_resize(f[l-1].data, f[l-1].size, f[l].data, f[l].size, STBIR_TYPE_FLOAT, 1);
+        m[l] = Map_new(f[l].size);
+        map_quantize(&m[l], &f[l], oft, Field_rect(&f[l]));
+    }
+    z__omp(parallel for schedule(dynamic) private(l, path))
+        for (l = 1; l <= levels; l++) {
+            /* Level l samples every 2^l-th cell, raw headers tell it as the coarse
+             * pass does, cell i averages level 0 around 2^l i + (2^l - 1) / 2 */
+            float scale = 1;
+            for (z__u32 i = 0; i < l; i++) scale *= 2;
+            fnl_state noise = ne->noise;
+            noise.frequency *= scale;
+            z__Vector3 at = {
+                .x = (ne->start.x + (scale - 1) / 2) / scale,
+                .y = (ne->start.y + (scale - 1) / 2) / scale,
+                .z = ne->start.z / scale,
+            };
+            mip_path(path, ne->write_to_file_name, l);
+            export_map(path, &m[l], &f[l], oft, ne->format, &noise, ne->gen, at);
+        }
+    for (l = 1; l <= levels; l++) {
+        Field_free(&f[l]);
+        Map_delete(&m[l]);
+    }
+    z__FREE(f);
+    z__FREE(m);
+}
+
+/**
+ * Slippy Map Tiles
+ * The world is a square -w noise cells across from the start position. Zoom z
+ * splits it in 2^z by 2^z tiles of SlippyTileW pixels, written as z/x/y with
+ * the extension of the format. Each tile is generated on its own at its zoom's
+ * scale, the same frequency trick as the explorer's coarse path, so no level
+ * is ever held whole.
+ *
+ * Tiles of every zoom are spread over the threads together. A tile already on
+ * disk is skipped, tiles are written under a temporary name and renamed when
+ * done so an interrupted run never leaves a partial one behind.
+ * Beyond SlippyZoomMax pixel coordinates no longer fit a float exactly.
+ */
+enum { SlippyTileW = 256, SlippyZoomMax = 15 };
+
+static char const *export_ext[] = {
+    [ExportRGB] = "png", [ExportGray16] = "png", [ExportHDR] = "hdr",
+    [ExportF32] = "f32", [ExportIndex] = "idx",
+};
+
+static void make_dir(char const *path)
+{
+    if(mkdir(path, 0755) && errno != EEXIST) die("Directory Not Created");
+}
+
+void export_tiles(struct ne_state *ne, OFormat *oft)
+{
+    if(ne->zoom > SlippyZoomMax) die("Zoom Too Deep");
+    /* Tiles sample the world -w cells across, without one there is no scale */
+    if(!ne->witdh) die("World Has No Width");
+    int reads_map = ne->format == ExportRGB || ne->format == ExportIndex;
+
+    /* Tile t of the whole run is tile t - first[z] of zoom z */
+    z__u64 first[SlippyZoomMax + 2] = {0};
+    make_dir(ne->tiles_dir);
+    for (z__u32 z = 0; z <= ne->zoom; z++) {
+        first[z + 1] = first[z] + ((z__u64)1 << z * 2);
+        char dir[ExportPathMax];
+        snprintf(dir, sizeof(dir), "%s/%u", ne->tiles_dir, z);
+        make_dir(dir);
+    }
+
+    z__u64 total = first[ne->zoom + 1], written = 0;
+    z__omp(parallel reduction(+:written))
+    {
+        Field field = Field_new((z__Vint2){.x = SlippyTileW, .y = SlippyTileW});
+        Map map = Map_new(field.size);
+        char path[ExportPathMax], part[ExportPathMax + 8];
+        z__u64 t = 0;
+
+        z__omp(for schedule(dynamic))
+            for (t = 0; t < total; t++) {
+                z__u32 z = 0;
+                while(t >= first[z + 1]) z++;
+                z__u32 side = 1u << z, tx = (t - first[z]) % side, ty = (t - first[z]) / side;
+
+                snprintf(path, sizeof(path), "%s/%u/%u", ne->tiles_dir, z, tx);
+                make_dir(path);
+                if(snprintf(path, sizeof(path), "%s/%u/%u/%u.%s", ne->tiles_dir, z, tx, ty
+                            , export_ext[ne->format]) >= (int)sizeof(path))
+                    die("Image Not Written");
+                if(!access(path, F_OK)) continue;
+
+                float step = (float)ne->witdh / (SlippyTileW << z);
+                fnl_state noise = ne->noise;
+                noise.frequency *= step;
+                z__Vector3 at = {
+                    .x = ne->start.x / step + (float)tx * SlippyTileW,
+                    .y = ne->start.y / step + (float)ty * SlippyTileW,
+                    .z = ne->start.z / step,
+                };
+                ne->gen(&field, &noise, at, Field_rect(&field));
+                if(reads_map) map_quantize(&map, &field, oft, Field_rect(&field));
+
+                snprintf(part, sizeof(part), "%s.part", path);
+                export_map(part, &map, &field, oft, ne->format, &noise, ne->gen, at);
+                if(rename(part, path)) die("Image Not Written");
+                written++;
+            }
+
+        Field_free(&field);
+        Map_delete(&map);
+    }
+
+    printf("tiles - %llu written, %llu skipped\n", (unsigned long long)written, (unsigned long long)(total - written));
+}
+
+void bench_gen(struct ne_state *ne, Map *map, Field *field, OFormat *oft)
+{
+    double total = 0, best = 0, qtotal = 0;
+    for (z__u32 i = 0; i < ne->bench; i++) {
+        double t = time_now_ms();
+        ne->gen(field, &ne->noise, ne->start, Field_rect(field));
+        double tq = time_now_ms();
+        map_quantize(map, field, oft, Field_rect(field));
+        tq = time_now_ms() - tq;
+        t = time_now_ms() - t - tq;
+
+        total += t;
+        qtotal += tq;
+        if(i == 0 || t < best) best = t;
+    }
+
+    double cells = (double)map->size.x * map->size.y;
+    fprintf(stdout,
+        "Bench: %u x %s %u x %u"
+        "\n" "  avg %.3f ms, best %.3f ms, %.2f Mcells/s"
+        "\n" "  quantize avg %.3f ms\n"
+        , ne->bench, ne->gen == gen_map3D? "gen_map3D": "gen_map2D", map->size.x, map->size.y
+        , total / ne->bench, best, cells / (total / ne->bench) / 1e3
+        , qtotal / ne->bench);
+}
+
+
+
+/* Resize map and field from one draw method's sample density to another's, regenerating both */
+void map_resample(Map *map, Field *field, OFormat *oft, fnl_state *noise, GenMapFn gen, z__Vector3 at
+        , z__Vint2 from, z__Vint2 to)
+{
+    z__Vint2 size = {
+        .x = map->size.x / from.x * to.x,
+        .y = map->size.y / from.y * to.y,
+    };
+    Field_free(field);
+    *field = Field_new(size);
+    Map_delete(map);
+    *map = Map_new(size);
+    gen(field, noise, at, Field_rect(field));
+    map_quantize(map, field, oft, Field_rect(field));
+}
+
+/**
+ * Tile Cache
+ * The world is cut into TileW x TileH tiles of noise, keyed by tile coordinates,
+ * the z slice and the fractional part of the view origin, so any view at the
+ * same fraction is assembled from the same tiles.
+ * Tiles live in one array, found through an open addressed table of index+1 and
+ * kept in LRU order by a list of indices, the tail is reused once the memory
+ * budget is spent. A tile is reserved before it is generated, `ready` marks it done.
+ */
+enum { TileW = 32, TileH = 32, TileNil = 0xffffffff };
+
+typedef struct TileKey {
+    z__i32 tx, ty;
+    float z, fx, fy;
+} TileKey;
+
+typedef struct Tile {
+    TileKey key;
+    z__u32 prev, next;
+    z__u8 ready;
+    float data[TileW * TileH];
+} Tile;
+
+typedef struct TileCache {
+    Tile *tiles;
+    z__u32 len, cap;
+    z__u32 *slots, slots_mask;
+    z__u32 head, tail;
+    z__u64 hits, misses;
+} TileCache;
+
+static z__u32 tile_key_hash(TileKey const *k)
+{
+    z__u32 bits[5];
+    memcpy(bits, k, sizeof(bits));
+    z__u64 h = 0x9e3779b97f4a7c15;
+    for (int i = 0; i < 5; i++) h = (h ^ bits[i]) * 0xff51afd7ed558ccd;
+    return h ^ (h >> 32);
+}
+
+static int tile_key_eq(TileKey const *a, TileKey const *b)
+{
+    return a->tx == b->tx && a->ty == b->ty && a->z == b->z && a->fx == b->fx && a->fy == b->fy;
+}
+
+static void tile_cache_insert_slot(TileCache *tc, z__u32 i)
+{
+    z__u32 s = tile_key_hash(&tc->tiles[i].key) & tc->slots_mask;
+    while(tc->slots[s]) s = (s + 1) & tc->slots_mask;
+    tc->slots[s] = i + 1;
+}
+
+/* Backward shift deletion, keeps every probe chain unbroken without tombstones */
+static void tile_cache_remove_slot(TileCache *tc, z__u32 i)
+{
+    z__u32 s = tile_key_hash(&tc->tiles[i].key) & tc->slots_mask;
+    while(tc->slots[s] != i + 1) s = (s + 1) & tc->slots_mask;
+
+    for (z__u32 n = (s + 1) & tc->slots_mask; tc->slots[n]; n = (n + 1) & tc->slots_mask) {
+        z__u32 home = tile_key_hash(&tc->tiles[tc->slots[n] - 1].key) & tc->slots_mask;
+        /* n may fill the hole unless its home lies cyclically in (s, n] */
+        if(((n - home) & tc->slots_mask) >= ((n - s) & tc->slots_mask)) {
+            tc->slots[s] = tc->slots[n];
+            s = n;
+        }
+    }
+    tc->slots[s] = 0;
+}
+
+static void tile_cache_unlink(TileCache *tc, z__u32 i)
+{
+    Tile *t = &tc->tiles[i];
+    if(t->prev != TileNil) tc->tiles[t->prev].next = t->next; else tc->head = t->next;
+    if(t->next != TileNil) tc->tiles[t->next].prev = t->prev; else tc->tail = t->prev;
+}
+
+static void tile_cache_push_front(TileCache *tc, z__u32 i)
+{
+    Tile *t = &tc->tiles[i];
+    t->prev = TileNil;
+    t->next = tc->head;
+    if(tc->head != TileNil) tc->tiles[tc->head].prev = i; else tc->tail = i;
+    tc->head = i;
+}
+
+/* Grow to hold at least `tiles` tiles, the slot table is rebuilt at twice that */
+void TileCache_reserve(TileCache *tc, z__u32 tiles)
+{
+    if(tiles <= tc->cap) return;
+    tc->tiles = z__REALLOC(tc->tiles, sizeof(*tc->tiles) * tiles);
+    tc->cap = tiles;
+
+    z__u32 slots = 1;
+    while(slots < tiles * 2) slots *= 2;
+    z__FREE(tc->slots);
+    tc->slots = z__CALLOC(slots, sizeof(*tc->slots));
+    tc->slots_mask = slots - 1;
+    for (z__u32 i = 0; i < tc->len; i++) tile_cache_insert_slot(tc, i);
+}
+
+/* A cache of about budget_bytes, never less than a couple of tiles */
+TileCache TileCache_new(z__size budget_bytes)
+{
+    TileCache tc = {.head = TileNil, .tail = TileNil};
+    z__size tiles = budget_bytes / sizeof(Tile);
+    TileCache_reserve(&tc, tiles > 2? tiles: 2);
+    return tc;
+}
+
+void TileCache_delete(TileCache *tc)
+{
+    z__FREE(tc->tiles);
+    z__FREE(tc->slots);
+    *tc = (TileCache){0};
+}
+
+/* Drop every tile, for when the noise itself changed */
+void TileCache_clear(TileCache *tc)
+{
+    memset(tc->slots, 0, sizeof(*tc->slots) * (tc->slots_mask + 1));
+    tc->len = 0;
+    tc->head = TileNil;
+    tc->tail = TileNil;
+}
+
+/* Tile at key, moved to the front of the LRU list, or NULL */
+Tile *TileCache_get(TileCache *tc, TileKey key)
+{
+    z__u32 s = tile_key_hash(&key) & tc->slots_mask;
+    for (; tc->slots[s]; s = (s + 1) & tc->slots_mask) {
+        z__u32 i = tc->slots[s] - 1;
+        if(tile_key_eq(&tc->tiles[i].key, &key)) {
+            tile_cache_unlink(tc, i);
+            tile_cache_push_front(tc, i);
+            return &tc->tiles[i];
+        }
+    }
+    return NULL;
+}
+
+/* Reserve a tile for key, not ready yet, evicting the least recently used when full */
+Tile *TileCache_put(TileCache *tc, TileKey key)
+{
+    z__u32 i = tc->len;
+    if(i < tc->cap) {
+        tc->len += 1;
+    } else {
+        i = tc->tail;
+        tile_cache_remove_slot(tc, i);
+        tile_cache_unlink(tc, i);
+    }
+    Tile *t = &tc->tiles[i];
+    t->key = key;
+    t->ready = 0;
+    tile_cache_insert_slot(tc, i);
+    tile_cache_push_front(tc, i);
+    return t;
+}
+
+static inline z__i64 floordiv(z__i64 a, z__i64 b)
+{
+    return a >= 0? a / b: -((-a + b - 1) / b);
+}
+
+enum { WorldBatch = 32, WorldCancelled = 0xffffffff };
+
+/**
+ * Assemble the field at `at` from the cache. Field cell (x, y) is world cell
+ * (floor(at.x) + x, floor(at.y) + y), tiles are generated at the fraction of at.
+ * Up to `limit` missing tiles are generated, in batches that stop once seq
+ * no longer reads seq_at, if seq is given. Returns the tiles still missing,
+ * WorldCancelled when stopped, view_tiles is set to the number of tiles the
+ * view covers. A field without data only generates, for prefetching.
+ */
+z__u32 world_fill(TileCache *tc, Field *field, fnl_state *noise, GenMapFn gen, z__Vector3 at
+        , z__u32 limit, atomic_uint *seq, z__u32 seq_at, z__u32 *view_tiles, double *ms_per_cell)
+{
+    z__i64 ox = floorf(at.x), oy = floorf(at.y);
+    TileKey key = {
+        .z = gen == gen_map2D? 0: at.z + 0.0f,
+        .fx = at.x - ox, .fy = at.y - oy,
+    };
+    z__i64 tx0 = floordiv(ox, TileW), tx1 = floordiv(ox + field->size.x - 1, TileW);
+    z__i64 ty0 = floordiv(oy, TileH), ty1 = floordiv(oy + field->size.y - 1, TileH);
+    z__u32 count = (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+    *view_tiles = count;
+
+    /* Every tile of the view has to fit at once, or reserving one could evict another */
+    TileCache_reserve(tc, count * 2);
+    Tile **view = z__MALLOC(sizeof(*view) * count);
+    Tile **miss = z__MALLOC(sizeof(*miss) * count);
+    z__u32 misses = 0, n = 0;
+    for (z__i64 ty = ty0; ty <= ty1; ty++)
+    for (z__i64 tx = tx0; tx <= tx1; tx++) {
+        key.tx = tx;
+        key.ty = ty;
+        Tile *t = TileCache_get(tc, key);
+        if(!t) t = TileCache_put(tc, key);
+        if(!t->ready) miss[misses++] = t;
+        view[n++] = t;
+    }
+
+    z__u32 todo = z__util_min_unsafe(limit, misses), done = 0;
+    while(done < todo) {
+        if(done && seq && atomic_load(seq) != seq_at) {
+            done = WorldCancelled;
+            break;
+        }
+        z__u32 batch = z__util_min_unsafe(WorldBatch, todo - done);
+        double t0 = time_now_ms();
+        z__size i = 0;
+        z__omp(parallel for schedule(dynamic) private(i))
+            for (i = done; i < done + batch; i++) {
+                Tile *t = miss[i];
+                Field tf = {.data = t->data, .size = {.x = TileW, .y = TileH}};
+                z__Vector3 start = {
+                    .x = key.fx + (double)t->key.tx * TileW,
+                    .y = key.fy + (double)t->key.ty * TileH,
+                    .z = at.z,
+                };
+                gen(&tf, noise, start, Field_rect(&tf));
+                t->ready = 1;
+            }
+        *ms_per_cell = (time_now_ms() - t0) / ((double)batch * TileW * TileH);
+        done += batch;
+    }
+
+    for (z__u32 i = 0; field->data && i < count; i++) {
+        Tile *t = view[i];
+        if(!t->ready) continue;
+        z__i64 x0 = t->key.tx * (z__i64)TileW - ox, y0 = t->key.ty * (z__i64)TileH - oy;
+        z__i64 lx = x0 < 0? -x0: 0, ly = y0 < 0? -y0: 0;
+        z__i64 w = z__util_min_unsafe(TileW, field->size.x - x0) - lx;
+        z__i64 h = z__util_min_unsafe(TileH, field->size.y - y0) - ly;
+        for (z__i64 y = ly; y < ly + h; y++) {
+            memcpy(field->data + (y0 + y) * field->size.x + x0 + lx
+                    , t->data + y * TileW + lx, sizeof(float) * w);
+        }
+    }
+    z__FREE(view);
+    z__FREE(miss);
+    return done == WorldCancelled? WorldCancelled: misses - done;
+}
+
+/**
+ * Generator Worker
+ * Explorer hands generation to a thread so drawing and input never wait on noise.
+ * The worker owns the field and a work map, finished frames are copied into one
+ * of three display maps and published by swapping an index with the drawer:
+ * the worker fills `back`, the drawer shows `front`, `ready` holds the newest
+ * finished one and is tagged GenReadyFresh until the drawer takes it.
+ *
+ * Requests coalesce, only the latest is ever run. A full regeneration goes in
+ * bands of rows and is dropped as soon as a newer request comes in, unless the
+ * last GenMaxCancel were dropped already, so constant input still shows frames.
+ *
+ * Every frame is assembled from the tile cache, only tiles not seen yet are
+ * generated. Cancelling keeps the tiles done so far, the next request picks up
+ * from there. While the view is moving and the missing tiles would not fit the
+ * frame budget, the field is generated on every 2nd or 4th cell and upsampled
+ * instead. Once no request came for a frame, the missing tiles are filled in.
+ *
+ * Between requests the worker prefetches tiles of the views the last velocity
+ * leads to, a frame ahead at a time. Prefetching drops out of a batch as soon
+ * as a request comes in, and starts over from the new position and velocity.
+ */
+typedef struct GenRequest {
+    z__Vector3 at, vel;
+    GenMapFn *gen;
+    z__u8 regen:1, requant:1, moving:1;
+} GenRequest;
+
+typedef struct GenWorker {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    /* Held while a request runs, hold it to touch noise or oft from outside */
+    pthread_mutex_t busy;
+
+    GenRequest req;
+    atomic_uint seq;
+    z__u8 pending:1, quit:1;
+    z__u8 cancelled;
+
+    Map *map;
+    Field *field;
+    OFormat *oft;
+    fnl_state *noise;
+    GenMapFn *gen;
+    z__Vector3 at, vel;
+    TileCache *cache;
+    /* Frames ahead prefetched so far, and tiles that took */
+    z__u32 ahead, ahead_tiles;
+
+    /* Tiles of the view that are still upsampled from coarse */
+    Field coarse;
+    z__u32 missing;
+    double ms_per_cell, budget_ms, last_req_ms;
+
+    Map shown[3];
+    atomic_int ready;
+    int back, front;
+} GenWorker;
+
+enum { GenReadyFresh = 4, GenMaxCancel = 2, GenMaxStride = 4, GenPrefetchFrames = 8 };
+
+/* Sample spacing that brings a full regeneration within the frame budget */
+static z__u32 gen_worker_stride(GenWorker *w)
+{
+    double cost = w->ms_per_cell * w->field->size.x * w->field->size.y;
+    z__u32 s = 1;
+    while(s < GenMaxStride && cost / (s * s) > w->budget_ms) s *= 2;
+    return s;
+}
+
+static void gen_worker_coarse(GenWorker *w, GenRequest *req, z__u32 s)
+{
+    Field *field = w->field, *coarse = &w->coarse;
+    z__Vint2 size = {.x = (field->size.x + s - 1) / s, .y = (field->size.y + s - 1) / s};
+    if(coarse->size.x != size.x || coarse->size.y != size.y) {
+        Field_free(coarse);
+        *coarse = Field_new(size);
+    }
+
+    /* Coordinates are multiplied by the frequency, so scaling it by s and the
+     * start by 1/s samples every s-th cell of the full field */
+    fnl_state noise = *w->noise;
+    noise.frequency *= s;
+    z__Vector3 at = {.x = req->at.x / s, .y = req->at.y / s, .z = req->at.z / s};
+    req->gen(coarse, &noise, at, Field_rect(coarse));
+
+    z__size y = 0;
+    z__omp(parallel for private(y))
+        for (y = 0; y < field->size.y; y++) {
+            float *dst = field->data + y * field->size.x;
+            float const *src = coarse->data + (y / s) * coarse->size.x;
+            for (z__size x = 0; x < field->size.x; x++) dst[x] = src[x / s];
+        }
+}
+
+/* Generate as many missing tiles as half a frame budget allows */
+static void gen_worker_refine(GenWorker *w)
+{
+    double tile_ms = w->ms_per_cell * TileW * TileH;
+    z__u32 limit = tile_ms > 0? w->budget_ms / 2 / tile_ms: w->missing;
+    z__u32 view_tiles;
+    w->missing = world_fill(w->cache, w->field, w->noise, w->gen, w->at, limit? limit: 1
+            , NULL, 0, &view_tiles, &w->ms_per_cell);
+    map_quantize(w->map, w->field, w->oft, Field_rect(w->field));
+}
+
+static int gen_worker_prefetch_due(GenWorker *w)
+{
+    if(!w->vel.x && !w->vel.y && (!w->vel.z || w->gen == gen_map2D)) return 0;
+    /* Stop short of pushing the tiles of the view itself out of the cache */
+    z__u32 view = (w->field->size.x / TileW + 2) * (w->field->size.y / TileH + 2);
+    return w->ahead < GenPrefetchFrames && w->ahead_tiles + view * 2 <= w->cache->cap;
+}
+
+/* Generate the tiles of the view one more frame ahead, unless a request comes in */
+static void gen_worker_prefetch(GenWorker *w, z__u32 seq)
+{
+    z__u32 ahead = w->ahead + 1, view_tiles;
+    z__Vector3 at = {
+        .x = w->at.x + w->vel.x * ahead,
+        .y = w->at.y + w->vel.y * ahead,
+        .z = w->at.z + w->vel.z * ahead,
+    };
+    Field ghost = {.size = w->field->size};
+    z__u32 left = world_fill(w->cache, &ghost, w->noise, w->gen, at, WorldCancelled
+            , &w->seq, seq, &view_tiles, &w->ms_per_cell);
+    if(left == WorldCancelled) return;
+    w->ahead = ahead;
+    w->ahead_tiles += view_tiles;
+}
+
+static int gen_worker_run(GenWorker *w, GenRequest *req, z__u32 seq)
+{
+    Field *field = w->field;
+    int fill = req->regen || w->missing || req->gen != w->gen
+            || req->at.x != w->at.x || req->at.y != w->at.y || req->at.z != w->at.z;
+
+    if(req->regen || req->gen != w->gen) TileCache_clear(w->cache);
+    if(fill) {
+        z__u32 view_tiles;
+        z__u32 missing = world_fill(w->cache, field, w->noise, req->gen, req->at, 0
+                , NULL, 0, &view_tiles, &w->ms_per_cell);
+        w->cache->hits += view_tiles - missing;
+        w->cache->misses += missing;
+
+        double cost = w->ms_per_cell * missing * TileW * TileH;
+        z__u32 stride = req->moving && cost > w->budget_ms? gen_worker_stride(w): 1;
+        if(stride > 1) {
+            gen_worker_coarse(w, req, stride);
+            /* Tiles that are there already beat the upsampled cells */
+            world_fill(w->cache, field, w->noise, req->gen, req->at, 0
+                    , NULL, 0, &view_tiles, &w->ms_per_cell);
+        } else if(missing) {
+            atomic_uint *cancel = w->cancelled < GenMaxCancel? &w->seq: NULL;
+            missing = world_fill(w->cache, field, w->noise, req->gen, req->at, missing
+                    , cancel, seq, &view_tiles, &w->ms_per_cell);
+            if(missing == WorldCancelled) {
+                w->cancelled += 1;
+                return 0;
+            }
+        }
+        w->missing = missing;
+    }
+    w->at = req->at;
+    w->vel = req->vel;
+    w->gen = req->gen;
+    w->cancelled = 0;
+    w->ahead = 0;
+    w->ahead_tiles = 0;
+
+    if(fill || req->requant) map_quantize(w->map, field, w->oft, Field_rect(field));
+    return 1;
+}
+
+static void gen_worker_publish(GenWorker *w)
+{
+    Map_copy(&w->shown[w->back], w->map);
+    w->back = atomic_exchange(&w->ready, w->back | GenReadyFresh) & ~GenReadyFresh;
+}
+
+static void *gen_worker_main(void *arg)
+{
+    GenWorker *w = arg;
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while(!w->pending && !w->quit) {
+            if(w->missing) {
+                /* Refine only once the view was left alone for a frame, with
+                 * some slack as a moving view requests exactly once a frame */
+                double still = w->last_req_ms + w->budget_ms * 1.5;
+                if(time_now_ms() < still) {
+                    struct timespec ts = time_ms_to_timespec(still);
+                    pthread_cond_timedwait(&w->wake, &w->lock, &ts);
+                    continue;
+                }
+                pthread_mutex_unlock(&w->lock);
+                pthread_mutex_lock(&w->busy);
+                gen_worker_refine(w);
+                gen_worker_publish(w);
+                pthread_mutex_unlock(&w->busy);
+                pthread_mutex_lock(&w->lock);
+                continue;
+            }
+            if(gen_worker_prefetch_due(w)) {
+                z__u32 seq = atomic_load(&w->seq);
+                pthread_mutex_unlock(&w->lock);
+                pthread_mutex_lock(&w->busy);
+                gen_worker_prefetch(w, seq);
+                pthread_mutex_unlock(&w->busy);
+                pthread_mutex_lock(&w->lock);
+                continue;
+            }
+            pthread_cond_wait(&w->wake, &w->lock);
+        }
+        if(w->quit) break;
+
+        GenRequest req = w->req;
+        z__u32 seq = atomic_load(&w->seq);
+        w->pending = 0;
+        w->req.regen = 0;
+        w->req.requant = 0;
+        pthread_mutex_unlock(&w->lock);
+
+        pthread_mutex_lock(&w->busy);
+        if(gen_worker_run(w, &req, seq)) gen_worker_publish(w);
+        pthread_mutex_unlock(&w->busy);
+
+        pthread_mutex_lock(&w->lock);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+/**
+ * map and field must hold the frame at `at` made by gen, the worker continues from there.
+ * cache must hold tiles of the same noise and gen, it outlives the worker.
+ * budget_ms is the time one frame may spend on generation.
+ */
+void gen_worker_start(GenWorker *w, Map *map, Field *field, OFormat *oft, fnl_state *noise
+        , GenMapFn *gen, z__Vector3 at, TileCache *cache, double budget_ms)
+{
+    *w = (GenWorker){
+        .map = map, .field = field, .oft = oft, .noise = noise, .gen = gen,
+        .at = at, .cache = cache, .budget_ms = budget_ms,
+        .back = 0, .ready = 1, .front = 2,
+    };
+    for (int i = 0; i < 3; i++) {
+        w->shown[i] = Map_new(map->size);
+        Map_copy(&w->shown[i], map);
+    }
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_mutex_init(&w->busy, NULL);
+    pthread_cond_init(&w->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    if(pthread_create(&w->thread, NULL, gen_worker_main, w)) die("Generator Thread Not Started");
+}
+
+void gen_worker_request(GenWorker *w, GenRequest req)
+{
+    pthread_mutex_lock(&w->lock);
+    req.regen |= w->req.regen;
+    req.requant |= w->req.requant;
+    w->req = req;
+    w->pending = 1;
+    w->last_req_ms = time_now_ms();
+    atomic_fetch_add(&w->seq, 1);
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/* Newest finished frame, or the one already shown if nothing new is done */
+Map *gen_worker_front(GenWorker *w)
+{
+    if(atomic_load(&w->ready) & GenReadyFresh) {
+        w->front = atomic_exchange(&w->ready, w->front) & ~GenReadyFresh;
+    }
+    return &w->shown[w->front];
+}
+
+void gen_worker_pause(GenWorker *w) { pthread_mutex_lock(&w->busy); }
+void gen_worker_resume(GenWorker *w) { pthread_mutex_unlock(&w->busy); }
+
+/* Paused only: after oft changed, no frame may hold indices of the old one */
+void gen_worker_requant(GenWorker *w)
+{
+    map_quantize(w->map, w->field, w->oft, Field_rect(w->field));
+    for (int i = 0; i < 3; i++) Map_copy(&w->shown[i], w->map);
+}
+
+/* Stops the thread, the worker's map is left with the last frame it finished */
+void gen_worker_stop(GenWorker *w)
+{
+    pthread_mutex_lock(&w->lock);
+    w->quit = 1;
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+
+    for (int i = 0; i < 3; i++) Map_delete(&w->shown[i]);
+    Field_free(&w->coarse);
+    pthread_mutex_destroy(&w->lock);
+    pthread_mutex_destroy(&w->busy);
+    pthread_cond_destroy(&w->wake);
+}
+
+/**
+ * Frame Pacer
+ * Frames start on deadlines `period` apart, the loop only sleeps what is left of
+ * the budget. Deadlines already missed are skipped instead of caught up on.
+ */
+typedef struct FramePacer {
+    double period, next, start, last;
+    float *times;
+    z__size len, cap;
+    z__u32 skipped;
+} FramePacer;
+
+FramePacer FramePacer_new(z__u32 fps)
+{
+    double now = time_now_ms();
+    return (FramePacer){
+        .period = 1e3 / (fps? fps: 1),
+        .next = now, .start = now, .last = now,
+    };
+}
+
+void FramePacer_delete(FramePacer *fp)
+{
+    z__FREE(fp->times);
+    memset(fp, 0, sizeof(*fp));
+}
+
+/* Record the frame just finished and wait for the next deadline */
+void FramePacer_wait(FramePacer *fp)
+{
+    double now = time_now_ms();
+    fp->next += fp->period;
+    if(fp->next <= now) {
+        fp->skipped += (now - fp->next) / fp->period + 1;
+        fp->next = now;
+    } else {
+        time_sleep_until_ms(fp->next);
+        now = time_now_ms();
+    }
+
+    /* Frame time is start to start, work and sleep */
+    if(fp->len >= fp->cap) {
+        fp->cap = fp->cap? fp->cap * 2: 256;
+        fp->times = z__REALLOC(fp->times, fp->cap * sizeof(*fp->times));
+    }
+    fp->times[fp->len++] = now - fp->last;
+    fp->last = now;
+}
+
+static int cmp_float(void const *a, void const *b)
+{
+    float x = *(float const *)a, y = *(float const *)b;
+    return (x > y) - (x < y);
+}
+
+void FramePacer_report(FramePacer *fp, FILE *f)
+{
+    if(!fp->len) return;
+    double elapsed = time_now_ms() - fp->start;
+    qsort(fp->times, fp->len, sizeof(*fp->times), cmp_float);
+
+    #define pct(p) fp->times[(z__size)((fp->len - 1) * (p) / 100)]
+    fprintf(f, "fps - %.1f (target %.1f)\n"
+               "frame ms - p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n"
+               "skipped - %u\n"
+        , fp->len / (elapsed / 1e3), 1e3 / fp->period
+        , pct(50), pct(95), pct(99), fp->times[fp->len - 1]
+        , fp->skipped);
+    #undef pct
+}
+
+/* Leaves map and field with the exact final frame, at_out and gen_out with where and how it was made */
+void explorer(Map *map, Field *field, OFormat *oft, fnl_state *noise, Drawfn draw, GenMapFn gen, z__Vector3 at
+        , z__u32 fps, z__u32 cache_mb, z__Vector3 *at_out, GenMapFn **gen_out)
+{
+    struct {
+        z__u8
+            cont:1,
+            regen:1,
+            requant:1;
+    } exp = {
+        .cont = 1,
+    };
+
+    z__Vector3 vel = {0};
+    Screen scr = {0};
+    FramePacer pacer = FramePacer_new(fps);
+    TileCache cache = TileCache_new((z__size)cache_mb << 20);
+    GenWorker worker;
+    gen_worker_start(&worker, map, field, oft, noise, gen, at, &cache, pacer.period);
+
+    char key = 0;
+
+    fputs(z__ansi_scr((cur_hide), (jump), (clear)), stdout);
+    z__termio_echo(false);
+    while(key != 'q') {
+        Drawfn *was_draw = draw;
+        switch(key) {
+            break; case 'w': vel.y--;
+            break; case 's': vel.y++;
+            break; case 'a': vel.x--;
+            break; case 'd': vel.x++;
+
+            break; case 'W': vel.y -= 4;
+            break; case 'S': vel.y += 4;
+            break; case 'A': vel.x -= 4;
+            break; case 'D': vel.x += 4;
+
+            break; case 'z': vel.z--;
+            break; case 'x': vel.z++;
+
+            break; case 'Z': vel.z -= 4;
+            break; case 'X': vel.z += 4;
+
+            break; case '[': gen = gen_map2D; exp.regen = 1;
+            break; case ']': gen = gen_map3D; exp.regen = 1;
+
+            break; case '1': draw = draw_map_char;
+            break; case '2': draw = draw_map_bgcolor;
+            break; case '3': draw = draw_map_half;
+            break; case '4': draw = draw_map_quad;
+            break; case '5': draw = draw_map_bg256;
+            break; case '6': draw = draw_map_bg16;
+
+            break; case ':': {
+                /* Commands edit noise and oft, keep the worker off them */
+                gen_worker_pause(&worker);
+                fputs(z__ansi_scr((cur_show))":", stdout);
+                z__termio_echo(true); z__termio_getkey_nowait();
+                switch(z__termio_getkey()) {
+                    break; case 'c': exp.cont = !exp.cont;
+                    break; case 'n': {
+                        char tmp[12] = { [11] = 0 };
+                        char tmp2[96] = { [95] = 0};
+                        scanf("%11s %95s", tmp, tmp2);
+                        int set_noise_argparse(fnl_state *noise, const char *arg0, const char *arg1);
+                        set_noise_argparse(noise, tmp, tmp2);
+                        exp.regen = 1;
+                    }
+
+                    break; case 'l': {
+                        char tmp[128];
+                        oft_command_parse(fgets(tmp, 127, stdin), oft);
+                        exp.requant = 1;
+                    }
+
+                    break; case 'h': fputs(
+                            z__ansi_scr((jump), (clear))
+                            "Color:\n"
+                            HELP_TXT_COLOR
+                            "\n"
+                            "Fnl Noise:\n"
+                            HELP_TXT_NOISE
+                            "\n"
+                            "\n", stdout);
+
+                    break; default: 
+                        fputs("Not a Valid Command\n", stdout);
+                }
+                fputs("Press Any Key\n", stdout);
+                z__termio_getkey();
+                z__termio_echo(false);
+                fputs(z__ansi_scr((cur_hide), (jump), (clear)), stdout);
+                Screen_invalidate(&scr);
+                gen_worker_requant(&worker);
+                gen_worker_resume(&worker);
+            }
+        }
+
+        /* Block methods want more samples per cell, start over at the new size */
+        z__Vint2 from = draw_samples(was_draw), to = draw_samples(draw);
+        if(from.x != to.x || from.y != to.y) {
+            gen_worker_stop(&worker);
+            map_resample(map, field, oft, noise, gen, at, from, to);
+            gen_worker_start(&worker, map, field, oft, noise, gen, at, &cache, pacer.period);
+        }
+
+        int moved = vel.x || vel.y || vel.z;
+        z__Vector3 step = vel;
+        z__Vector3_A(at, vel, +, &at);
+        if(!exp.cont) {
+            vel.raw[0] = 0;
+            vel.raw[1] = 0;
+            vel.raw[2] = 0;
+        }
+
+        /* Palette edits and draw switches reuse the field, pans reuse cached tiles */
+        if(moved || exp.regen || exp.requant) {
+            gen_worker_request(&worker, (GenRequest){
+                .at = at, .vel = step, .gen = gen, .regen = exp.regen, .requant = exp.requant,
+                .moving = moved
+            });
+        }
+        exp.regen = 0;
+        exp.requant = 0;
+
+        screen_present(&scr, gen_worker_front(&worker), oft, draw);
+
+        key = z__termio_getkey_nowait();
+        FramePacer_wait(&pacer);
+    }
+    gen_worker_stop(&worker);
+
+    /* The last frame may still be upsampled from coarse, hold cells of a
+     * cancelled fill or not be made at all, the map has to leave exact */
+    int exact = !worker.pending && !worker.missing && worker.gen == gen
+            && worker.at.x == at.x && worker.at.y == at.y && worker.at.z == at.z;
+    if(!exact) {
+        gen(field, noise, at, Field_rect(field));
+        map_quantize(map, field, oft, Field_rect(field));
+    }
+    *at_out = at;
+    *gen_out = gen;
+
+    Screen_delete(&scr);
+    fputs(z__ansi_scr((cur_show)), stdout);
+    z__termio_echo(true);
+
+    fprintf(stdout, "x - %f\n"
+                    "y - %f\n"
+                    "z = %f\n", at.x, at.y, at.z);
+    fprintf(stdout, "tiles - %llu hits, %llu misses, %u cached (%.1f MB)\n"
+        , (unsigned long long)cache.hits, (unsigned long long)cache.misses
+        , cache.len, cache.len * sizeof(Tile) / 1048576.0);
+    TileCache_delete(&cache);
+    FramePacer_report(&pacer, stdout);
+    FramePacer_delete(&pacer);
+}
+
+void print_state_details(struct ne_state *ne, OFormat *oft, Map *map, Field *field)
 {
     fputs( "\n"
          "NE Report\n"
@@ -693,13 +2656,22 @@ void print_state_details(struct ne_state *ne, OFormat *oft, Map *map)
     fputs( "\n"
          "System\n"
          "=======", stdout);
+    static char const *simd_names[] = {
+        [FNL_SIMD_NONE] = "none",
+        [FNL_SIMD_SSE41] = "sse4.1",
+        [FNL_SIMD_AVX2] = "avx2",
+    };
     fprintf(stdout,
+        "\n" "Noise SIMD: %s"
         "\n" "Ram Usage: %zu bytes"
         "\n" "Map Size: %zu bytes + Struct %zu bytes"
+        "\n" "Field Size: %zu bytes"
         "\n" "Oft Color: %zu bytes"
         "\n" "Oft Char: %zu bytes"
+    , simd_names[fnlGetSIMDLevel()]
     , z__sys_getRamUsage()
-    , sizeof(**map->chunks) * map->size.x * map->size.y * map->size.z * map->chunkAndObjCount, sizeof(*map)
+    , Map_get_size(map), sizeof(*map)
+    , sizeof(*field->data) * field->size.x * field->size.y
     , sizeof(*oft->color.bg) * 2 * oft->color_len
     , sizeof(*oft->ch) * oft->ch_len);
 
@@ -728,12 +2700,31 @@ Drawfn* get_drawmethod(char const *arg)
     z__argp_start(s, 0, 1) {
         z__argp_ifarg_custom("char")    return draw_map_char;
         z__argp_elifarg_custom("obg")      return draw_map_bgcolor;
+        z__argp_elifarg_custom("half")     return draw_map_half;
+        z__argp_elifarg_custom("quad")     return draw_map_quad;
+        z__argp_elifarg_custom("bg256")    return draw_map_bg256;
+        z__argp_elifarg_custom("bg16")     return draw_map_bg16;
     }
 
     printf("`%s` Not a Valid Draw Method, Defaulting to Only BG Color\n", *s);
     return draw_map_bgcolor;
 }
 
+ExportFormat get_export_format(char const *arg)
+{
+    char const **s = &arg;
+    z__argp_start(s, 0, 1) {
+        z__argp_ifarg_custom("rgb")       return ExportRGB;
+        z__argp_elifarg_custom("gray16")   return ExportGray16;
+        z__argp_elifarg_custom("hdr")      return ExportHDR;
+        z__argp_elifarg_custom("f32")      return ExportF32;
+        z__argp_elifarg_custom("idx")      return ExportIndex;
+    }
+
+    printf("`%s` Not a Valid Format, Defaulting to rgb\n", *s);
+    return ExportRGB;
+}
+
 fnl_fractal_type get_fnl_fractal_type(char const *arg)
 {
     char const **s = &arg;
@@ -846,35 +2837,27 @@ int set_noise_argparse(fnl_state *noise, const char *arg0, const char *arg1)
     return 1;
 }
 
-struct ne_state argparse(char const **argv, z__u32 argc, OFormat *oft)
+/* Parse argv into ne over what it already holds, from argv[1] on.
+ * oft is NULL for batch jobs, which share the palette of the command line */
+void argparse_over(struct ne_state *ne, char const **argv, z__u32 argc, OFormat *oft)
 {
-    struct ne_state ne = { 
-        .height = 15
-      , .witdh = 40
-      , .noise = fnlCreateState()
-      , .color = 255
-      , .write_to_file_name = "stdout.png"
-      , .draw = draw_map_bgcolor
-      , .gen = gen_map2D
-    };
-
     z__argp_start(argv, 1, argc) {
         /**
          * Basic Stuff
          */
-        z__argp_ifarg(&ne.witdh, "-w", "--width")
-        z__argp_elifarg(&ne.height, "-h", "--height")
+        z__argp_ifarg(&ne->witdh, "-w", "--width")
+        z__argp_elifarg(&ne->height, "-h", "--height")
         
-        z__argp_elifarg(&ne.start.x, "-x", "--startx")
-        z__argp_elifarg(&ne.start.y, "-y", "--starty")
-        z__argp_elifarg(&ne.start.z, "-z", "--startz")
+        z__argp_elifarg(&ne->start.x, "-x", "--startx")
+        z__argp_elifarg(&ne->start.y, "-y", "--starty")
+        z__argp_elifarg(&ne->start.z, "-z", "--startz")
 
         z__argp_elifarg_custom("--gen") {
             z__argp_next();
             char const *tmp = z__argp_get();
-            if(tmp[0] == '3' && (tmp[1] == 'd' || tmp[1] == 'D')) ne.gen = gen_map3D;
-            else if(tmp[0] == '2' && (tmp[1] == 'd' || tmp[1] == 'D')) ne.gen = gen_map2D;
-            else ne.gen = gen_map2D;
+            if(tmp[0] == '3' && (tmp[1] == 'd' || tmp[1] == 'D')) ne->gen = gen_map3D;
+            else if(tmp[0] == '2' && (tmp[1] == 'd' || tmp[1] == 'D')) ne->gen = gen_map2D;
+            else ne->gen = gen_map2D;
         }
 
         /**
@@ -882,52 +2865,79 @@ struct ne_state argparse(char const **argv, z__u32 argc, OFormat *oft)
          */
         z__argp_elifarg_custom("-r", "--write") {
             z__argp_next();
-            ne.write_to_file = 1;
-            ne.write_to_file_name = z__argp_get();
+            ne->write_to_file = 1;
+            ne->write_to_file_name = z__argp_get();
         }
 
         /**
          * Explorer Mode
          */
         z__argp_elifarg_custom("-e") {
-            ne.explorer = 1;
+            ne->explorer = 1;
         }
 
         /**
          * Draw Stuff
          */
         z__argp_elifarg_custom("-p", "--noprint") {
-           ne.no_print = 1; 
+           ne->no_print = 1; 
         }
 
         z__argp_elifarg_custom("-d", "--draw") {
             z__argp_next();
-            ne.draw = get_drawmethod(z__argp_get());
+            ne->draw = get_drawmethod(z__argp_get());
         }
 
         /**
          * OFormat Stuff
          */
         z__argp_elifarg_custom("--cc") {
+            if(!oft) die("Palette and Charlist options are not allowed in a batch job");
             z__argp_next();
             oft_replace_chlist(oft, z__argp_get(), strlen(z__argp_get()));
         }
 
-        z__argp_elifarg(&ne.color, "-c", "--color_num")
+        z__argp_elifarg_custom("-c", "--color_num") {
+            if(!oft) die("Palette and Charlist options are not allowed in a batch job");
+            z__argp_next();
+            z__strto(z__argp_get(), &ne->color);
+        }
 
         z__argp_elifarg_custom("--cmd") {
+            if(!oft) die("Palette and Charlist options are not allowed in a batch job");
             z__argp_next();
             oft_command_parse(z__argp_get(), oft);
-            ne.custom_oft_colorl = 1;
+            ne->custom_oft_colorl = 1;
         }
 
         z__argp_elifarg_custom("--cmdfile") {
+            if(!oft) die("Palette and Charlist options are not allowed in a batch job");
             z__argp_next();
-            ne.custom_oft_colorl |= oft_readFromFile(oft, z__argp_get()).st.color_changed;
+            ne->custom_oft_colorl |= oft_readFromFile(oft, z__argp_get()).st.color_changed;
+        }
+
+        z__argp_elifarg(&ne->bench, "-b", "--bench")
+        z__argp_elifarg(&ne->fps, "-F", "--fps")
+        z__argp_elifarg(&ne->cache, "-C", "--cache")
+        z__argp_elifarg(&ne->png_level, "-L", "--level")
+        z__argp_elifarg(&ne->mips, "-m", "--mips")
+        z__argp_elifarg_custom("--batch") {
+            z__argp_next();
+            ne->batch_file = z__argp_get();
+        }
+        z__argp_elifarg(&ne->jobs, "-j", "--jobs")
+        z__argp_elifarg_custom("-T", "--tiles") {
+            z__argp_next();
+            ne->tiles_dir = z__argp_get();
+        }
+        z__argp_elifarg(&ne->zoom, "-Z", "--zoom")
+        z__argp_elifarg_custom("-f", "--format") {
+            z__argp_next();
+            ne->format = get_export_format(z__argp_get());
         }
 
         z__argp_elifarg_custom("-v", "--verbose") {
-            ne.verbose = 1;
+            ne->verbose = 1;
         }
 
         /**
@@ -935,8 +2945,8 @@ struct ne_state argparse(char const **argv, z__u32 argc, OFormat *oft)
          */
         z__argp_elifarg_custom("-?", "--help") {
             puts(HELP_INTRO HELP_TXT);
-            ne.exit = 1;
-            return ne;
+            ne->exit = 1;
+            return;
         }
 
         else {
@@ -945,16 +2955,178 @@ struct ne_state argparse(char const **argv, z__u32 argc, OFormat *oft)
             && s[1] == '-'
             && s[2] == 'n') {
                 z__argp_next();
-                set_noise_argparse(&ne.noise, s + 3, z__argp_get());
+                set_noise_argparse(&ne->noise, s + 3, z__argp_get());
             }
         }
     }
+}
 
+struct ne_state argparse(char const **argv, z__u32 argc, OFormat *oft)
+{
+    struct ne_state ne = { 
+        .height = 15
+      , .witdh = 40
+      , .noise = fnlCreateState()
+      , .color = 255
+      , .fps = 25
+      , .cache = 64
+      , .png_level = 8
+      , .jobs = 1
+      , .write_to_file_name = "stdout.png"
+      , .draw = draw_map_bgcolor
+      , .gen = gen_map2D
+    };
+    argparse_over(&ne, argv, argc, oft);
     return ne;
 }
 
+/**
+ * Batch
+ * Every line of a batch file is one job, written like the command line, e.g.
+ *     -w 512 -h 512 --nseed 7 --nf 0.02 -r seed7.png
+ * Jobs start from the options of the command line and override them, # starts
+ * a comment line and "quotes" keep spaces in a token. The palette and charlist
+ * are built once from the command line and shared by every job.
+ *
+ * -j jobs run at once, each with its share of the threads, and every thread
+ * keeps its field and map from one job to the next, growing them as needed.
+ * Jobs go out whole, as -m and -T would have them, the explorer, bench and
+ * terminal print are ignored.
+ */
+typedef struct BatchJob {
+    struct ne_state ne;
+    z__u32 line;
+} BatchJob;
+
+/* Split line in place into argv[1..], returns the token count plus one */
+static z__u32 batch_split(char *line, char const **argv, z__u32 max)
+{
+    z__u32 argc = 1;
+    argv[0] = "ne";
+    while(*line) {
+        while(isspace((unsigned char)*line)) line++;
+        if(!*line) break;
+        if(argc == max) die("Batch Line Too Long");
+
+        char end = ' ';
+        if(*line == '"') end = *line++;
+        argv[argc++] = line;
+        while(*line && (end == '"'? *line != '"': !isspace((unsigned char)*line))) line++;
+        if(*line) *line++ = 0;
+    }
+    return argc;
+}
+
+/* Read path into jobs over base, text keeps the strings they point into */
+static BatchJob *batch_load(char const *path, struct ne_state const *base, z__u32 *count, char **text)
+{
+    FILE *fp = fopen(path, "r");
+    if(!fp) die("Batch File Not Read");
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    rewind(fp);
+    *text = z__MALLOC(len + 1);
+    if(fread(*text, 1, len, fp) != (z__size)len) die("Batch File Not Read");
+    (*text)[len] = 0;
+    fclose(fp);
+
+    z__u32 cap = 16, n = 0, line = 0;
+    BatchJob *jobs = z__MALLOC(sizeof(*jobs) * cap);
+    char const *argv[256];
+    for (char *at = *text, *next; at; at = next) {
+        next = strchr(at, '\n');
+        if(next) *next++ = 0;
+        line++;
+
+        z__u32 argc = batch_split(at, argv, sizeof(argv)/sizeof(*argv));
+        if(argc == 1 || argv[1][0] == '#') continue;
+
+        if(n == cap) {
+            cap *= 2;
+            jobs = z__REALLOC(jobs, sizeof(*jobs) * cap);
+        }
+        jobs[n] = (BatchJob){.ne = *base, .line = line};
+        jobs[n].ne.write_to_file = 0;
+        argparse_over(&jobs[n].ne, argv, argc, NULL);
+        if(!jobs[n].ne.write_to_file && !jobs[n].ne.tiles_dir) {
+            printf("Batch line %u has no -r or -T\n", line);
+            exit(1);
+        }
+        n++;
+    }
+
+    *count = n;
+    return jobs;
+}
+
+void run_batch(struct ne_state *ne, OFormat *oft)
+{
+    char *text;
+    z__u32 count, i = 0;
+    BatchJob *jobs = batch_load(ne->batch_file, ne, &count, &text);
+    z__u32 at_once = z__util_max_unsafe(ne->jobs, 1);
+    double t0 = time_now_ms();
+
+#ifdef _OPENMP
+    /* Threads left over from the jobs go to the work within them */
+    z__u32 inner = z__util_max_unsafe(omp_get_max_threads() / (int)at_once, 1);
+    omp_set_max_active_levels(2);
+#endif
+
+    z__omp(parallel num_threads(at_once))
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(inner);
+#endif
+        Field field = {0};
+        Map map = {0};
+        z__size cap = 0;
+
+        z__omp(for schedule(dynamic))
+            for (i = 0; i < count; i++) {
+                struct ne_state *job = &jobs[i].ne;
+                if(job->tiles_dir) {
+                    export_tiles(job, oft);
+                    continue;
+                }
+
+                z__Vint2 samples = draw_samples(job->draw);
+                z__Vint2 size = {.x = job->witdh * samples.x, .y = job->height * samples.y};
+                z__size cells = (z__size)size.x * size.y;
+                if(cells > cap) {
+                    Field_free(&field);
+                    Map_delete(&map);
+                    field = Field_new(size);
+                    map = Map_new(size);
+                    Map_fit(&map, oft);
+                    cap = cells;
+                }
+                /* Planes were fitted to oft at cap cells, smaller jobs reuse them as
+                 * they are, which only holds while no job changes the index widths */
+                if(map.ch_bytes != Map_index_bytes(oft->ch_lenUsed)
+                || map.clr_bytes != Map_index_bytes(oft->color_lenUsed))
+                    die("Batch Palette Changed");
+                field.size = map.size = size;
+
+                job->gen(&field, &job->noise, job->start, Field_rect(&field));
+                map_quantize_fitted(&map, &field, oft, Field_rect(&field));
+                export_map(job->write_to_file_name, &map, &field, oft, job->format, &job->noise, job->gen, job->start);
+                if(job->mips) export_mips(job, &map, &field, oft);
+            }
+
+        Field_free(&field);
+        Map_delete(&map);
+    }
+
+    printf("batch - %u jobs in %.2f s\n", count, (time_now_ms() - t0) / 1000);
+    z__FREE(jobs);
+    z__FREE(text);
+}
+
 int main(int argc, char const *argv[])
 {
+    /* Noise kernels are picked here, before any generator thread needs them */
+    fnlGetSIMDLevel();
 
     /* Color and Char Format */
     OFormat oft = oft_new("0123456789ABCDEF", sizeof "0123456789ABCDEF"-1);
@@ -985,41 +3157,69 @@ int main(int argc, char const *argv[])
 
 
     /**
-     * Map to store noise data
+     * A map that only goes to file is generated band by band as it is written
      */
-    Map *map = z__MALLOC(sizeof *map);
-    zsf_MapCh_createEmpty(map, ne.witdh, ne.height, 1, 0);
+    stbi_write_png_compression_level = ne.png_level;
+    z__Vint2 samples = draw_samples(ne.draw);
+    if(ne.batch_file) {
+        run_batch(&ne, &oft);
+        oft_delete(&oft);
+        return 0;
+    }
+    if(ne.tiles_dir) {
+        export_tiles(&ne, &oft);
+        oft_delete(&oft);
+        return 0;
+    }
+    if(ne.write_to_file && ne.no_print && !ne.explorer && !ne.bench && !ne.verbose && !ne.mips) {
+        z__Vint2 size = {.x = ne.witdh * samples.x, .y = ne.height * samples.y};
+        export_gen(ne.write_to_file_name, size, &ne.noise, ne.gen, ne.start, &oft, ne.format);
+        oft_delete(&oft);
+        return 0;
+    }
+
+    /**
+     * Field to store noise data, Map to store what is drawn from it
+     */
+    Field field = Field_new((z__Vint2){.x = ne.witdh * samples.x, .y = ne.height * samples.y});
+    Map map = Map_new(field.size);
    
-    ne.gen(map, &oft, &ne.noise, ne.start);
+    ne.gen(&field, &ne.noise, ne.start, Field_rect(&field));
+    map_quantize(&map, &field, &oft, Field_rect(&field));
+
+    if(ne.bench) {
+        bench_gen(&ne, &map, &field, &oft);
+    }
     
     if(!ne.explorer) {
         if(!ne.no_print) {
-            ne.draw(map, &oft);
+            ne.draw(&map, &oft);
             fputs(z__ansi_fmt((plain)), stdout);
         }
     } else {
         z__u32 x, y;
         z__termio_get_term_size(&x, &y);
-        if(x > map->size.x && y > map->size.y) {
-            explorer(map, &oft, &ne.noise, ne.draw, ne.gen, ne.start);
+        if(x > ne.witdh && y > ne.height) {
+            /* What gets written is where the explorer was left, made as it was left */
+            explorer(&map, &field, &oft, &ne.noise, ne.draw, ne.gen, ne.start, ne.fps, ne.cache
+                    , &ne.start, &ne.gen);
         } else {
             printf("Your Terminal Size %d rows, %d colums are too small for generated noise map: %d x %d"
-                    , y, x, map->size.x, map->size.y);
+                    , y, x, ne.witdh, ne.height);
         }
     }
         
     if(ne.write_to_file) {
-        Image img = Image_newFrom_map(map, &oft);
-        Image_write_png(ne.write_to_file_name, &img);
-        Image_free(&img);
+        export_map(ne.write_to_file_name, &map, &field, &oft, ne.format, &ne.noise, ne.gen, ne.start);
+        if(ne.mips) export_mips(&ne, &map, &field, &oft);
     }
 
     if(ne.verbose) {
-        print_state_details(&ne, &oft, map);
+        print_state_details(&ne, &oft, &map, &field);
     }
 
     oft_delete(&oft);
-    zsf_MapCh_delete(map);
-    z__FREE(map);
+    Map_delete(&map);
+    Field_free(&field);
     return 0;
 }